@@ -0,0 +1,277 @@
+/**
+ * kernel_bench.cpp
+ *
+ * Microbenchmarks of the row kernels and alive functions on their own, for
+ * every width class they handle and working sets that fit in L1, L2, L3 or
+ * only in DRAM. Prints one CSV line per kernel, width and working set, in the
+ * same order every run, so that results can be diffed between revisions.
+ *
+ * Cycles are TSC cycles, which tick at the nominal frequency of the processor
+ * whatever its current clock is. GB/s counts every cell read and written
+ * once, the least traffic a generation can cause.
+ *
+ * Usage: kernel_bench [kernel name prefix]
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <x86intrin.h>
+
+#include <cpu_seq.hpp>
+#include <cpu_simd.hpp>
+#include <util.hpp>
+
+// Minimum time of one measured repetition, and repetitions of which the
+// fastest is reported.
+const double bench_min_ms = 20;
+const int bench_reps = 5;
+
+struct bench_world
+{
+    char* grid;
+    char* buf;
+
+    // Neighbor counts for the alive functions, 0 to 8 per cell.
+    char* counts;
+    int width;
+    int height;
+};
+
+typedef void (*bench_gen_t)(bench_world& world);
+typedef bool (*bench_fits_t)(int width);
+
+struct bench_kernel
+{
+    const char* name;
+    bench_fits_t fits;
+    bench_gen_t gen;
+
+    // Bytes read and written per cell, also the number of arrays of the
+    // working set.
+    int bytes_per_cell;
+
+    // Whether the result is a generation that can be checked against
+    // cpu_seq_row.
+    bool checked;
+};
+
+struct bench_level
+{
+    const char* name;
+    size_t bytes;
+};
+
+/* Generation of a row kernel of any width. */
+template <void (*row)(char*, char*, int, int, int, int)>
+static void bench_rows(bench_world& world)
+{
+    int height = world.height;
+    for (int y = 0; y < height; y++) {
+        row(world.grid, world.buf, world.width, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+    }
+}
+
+/* Generation of a row kernel of one width. */
+template <void (*row)(char*, char*, int, int, int)>
+static void bench_rows_w(bench_world& world)
+{
+    int height = world.height;
+    for (int y = 0; y < height; y++) {
+        row(world.grid, world.buf, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+    }
+}
+
+static void bench_fixed(bench_world& world)
+{
+    cpu_simd_fixed_rows_for(world.width)(world.grid, world.buf, world.height, 0, world.height);
+}
+
+static void bench_rowsum(bench_world& world)
+{
+    cpu_simd_rowsum_rows(world.grid, world.buf, world.width, world.height, 0, world.height);
+}
+
+/* Next states of every cell from its neighbor count, without computing the
+counts. */
+static void bench_int_alive(bench_world& world)
+{
+    size_t size = (size_t)world.width * world.height;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t cells = *(uint64_t*)(world.grid + i);
+        uint64_t neighbors_count = *(uint64_t*)(world.counts + i);
+        *(uint64_t*)(world.buf + i) = cpu_simd_int_alive<uint64_t>(cells, neighbors_count);
+    }
+}
+
+static void bench_16_alive(bench_world& world)
+{
+    size_t size = (size_t)world.width * world.height;
+    for (size_t i = 0; i + 16 <= size; i += 16) {
+        __m128i cells = _mm_loadu_si128((__m128i*)(world.grid + i));
+        __m128i neighbors_count = _mm_loadu_si128((__m128i*)(world.counts + i));
+        _mm_storeu_si128((__m128i*)(world.buf + i), cpu_simd_16_alive(cells, neighbors_count));
+    }
+}
+
+static bool fits_any(int width) { return width >= 2; }
+static bool fits_4(int width) { return width == 4; }
+static bool fits_gt_4(int width) { return width > 4; }
+static bool fits_8(int width) { return width == 8; }
+static bool fits_gt_8(int width) { return width > 8; }
+static bool fits_16(int width) { return width == 16; }
+static bool fits_gt_16(int width) { return width > 16; }
+static bool fits_fixed(int width) { return cpu_simd_fixed_rows_for(width) != nullptr; }
+
+// The alive functions do not depend on the width, so they run once.
+static bool fits_alive(int width) { return width == 4096; }
+
+static const bench_kernel bench_kernels[] = {
+    {"cpu_seq_row", fits_any, bench_rows<cpu_seq_row>, 2, true},
+    {"cpu_simd_int_row_intw<uint32_t>", fits_4, bench_rows_w<cpu_simd_int_row_intw<uint32_t>>, 2, true},
+    {"cpu_simd_int_row<uint32_t>", fits_gt_4, bench_rows<cpu_simd_int_row<uint32_t>>, 2, true},
+    {"cpu_simd_int_row_intw<uint64_t>", fits_8, bench_rows_w<cpu_simd_int_row_intw<uint64_t>>, 2, true},
+    {"cpu_simd_int_row<uint64_t>", fits_gt_8, bench_rows<cpu_simd_int_row<uint64_t>>, 2, true},
+    {"cpu_simd_16_row_16w", fits_16, bench_rows_w<cpu_simd_16_row_16w>, 2, true},
+    {"cpu_simd_16_row", fits_gt_16, bench_rows<cpu_simd_16_row>, 2, true},
+    {"cpu_simd_row", fits_any, bench_rows<cpu_simd_row>, 2, true},
+    {"cpu_simd_fixed_rows", fits_fixed, bench_fixed, 2, true},
+    {"cpu_simd_rowsum_rows", fits_any, bench_rowsum, 2, true},
+    {"cpu_simd_int_alive<uint64_t>", fits_alive, bench_int_alive, 3, false},
+    {"cpu_simd_16_alive", fits_alive, bench_16_alive, 3, false},
+};
+
+// One width of every class the row kernels tell apart: the integer widths,
+// their multiples and non-multiples, every fixed width and wide rows.
+static const int bench_widths[] = {4, 6, 8, 12, 16, 24, 32, 48, 64, 100, 128, 256, 1000, 4096};
+
+/* Returns a cache size from sysconf, or fallback if it is not known. */
+static size_t cache_size(int name, size_t fallback)
+{
+    long size = sysconf(name);
+    return size > 0 ? size : fallback;
+}
+
+/* Working sets half the size of every cache level, so that the world and the
+stack fit alongside each other, and one that fits in no cache. */
+static std::vector<bench_level> bench_levels()
+{
+    size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+    size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, 256 << 10);
+    size_t l3 = cache_size(_SC_LEVEL3_CACHE_SIZE, 8 << 20);
+    return std::vector<bench_level>{
+        {"L1", l1 / 2},
+        {"L2", l2 / 2},
+        {"L3", l3 / 2},
+        {"DRAM", std::max(l3 * 2, (size_t)64 << 20)},
+    };
+}
+
+/* Checks one generation of a kernel against cpu_seq_row. */
+static void bench_check(const bench_kernel& kernel, bench_world& world)
+{
+    size_t size = (size_t)world.width * world.height;
+    std::vector<char> expected(size);
+    bench_world seq = world;
+    seq.buf = expected.data();
+    bench_rows<cpu_seq_row>(seq);
+    kernel.gen(world);
+    if (memcmp(world.buf, expected.data(), size)) {
+        throw std::runtime_error(std::string(kernel.name) + " is wrong for width " +
+            std::to_string(world.width));
+    }
+}
+
+/* Runs gens generations, returns the TSC cycles and ms they took. */
+static void bench_run(const bench_kernel& kernel, bench_world& world, int gens, uint64_t* cycles, double* ms)
+{
+    my_timer timer;
+    timer.start();
+    uint64_t start = __rdtsc();
+    for (int i = 0; i < gens; i++) {
+        kernel.gen(world);
+        swap_ptr((void**)&world.grid, (void**)&world.buf);
+    }
+    *cycles = __rdtsc() - start;
+    *ms = timer.stop();
+}
+
+/* Benchmarks a kernel on a world of the given width that fills the working 
+set of level. The kernel is checked first if check is set. */
+static void bench(const bench_kernel& kernel, int width, const bench_level& level, bool check)
+{
+    // Height for the working set of the level, at least the three rows the
+    // kernels need.
+    int arrays = kernel.bytes_per_cell;
+    int height = std::max((size_t)3, level.bytes / arrays / width);
+    size_t size = (size_t)width * height;
+
+    // A quarter of the cells alive, from xorshift since rand() would take
+    // longer than the benchmark on the DRAM working set.
+    std::vector<char> grid(size), buf(size), counts(size);
+    uint64_t random = 88172645463325252ull;
+    for (size_t i = 0; i < size; i++) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        grid[i] = (random & 3) == 0;
+        counts[i] = (random >> 8) % 9;
+    }
+    bench_world world{grid.data(), buf.data(), counts.data(), width, height};
+    if (check && kernel.checked) {
+        bench_check(kernel, world);
+    }
+
+    // Generations per repetition, doubled until a repetition takes long
+    // enough to time.
+    uint64_t cycles;
+    double ms;
+    int gens = 1;
+    bench_run(kernel, world, gens, &cycles, &ms);
+    while (ms < bench_min_ms) {
+        gens *= 2;
+        bench_run(kernel, world, gens, &cycles, &ms);
+    }
+
+    uint64_t best_cycles = cycles;
+    double best_ms = ms;
+    for (int i = 1; i < bench_reps; i++) {
+        bench_run(kernel, world, gens, &cycles, &ms);
+        best_cycles = std::min(best_cycles, cycles);
+        best_ms = std::min(best_ms, ms);
+    }
+
+    double cells = (double)size * gens;
+    printf("%s,%d,%d,%s,%zu,%d,%.4f,%.4f,%.3f\n", kernel.name, width, height, level.name,
+        size * arrays, gens, best_cycles / cells, best_ms * 1e6 / cells,
+        cells * kernel.bytes_per_cell / (best_ms * 1e6));
+    fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    std::string prefix = argc > 1 ? argv[1] : "";
+    std::vector<bench_level> levels = bench_levels();
+
+    printf("kernel,width,height,level,working_set_bytes,gens,cycles_per_cell,ns_per_cell,gb_per_s\n");
+    for (const bench_kernel& kernel : bench_kernels) {
+        if (std::string(kernel.name).compare(0, prefix.size(), prefix)) {
+            continue;
+        }
+        for (int width : bench_widths) {
+            if (!kernel.fits(width)) {
+                continue;
+            }
+            for (size_t i = 0; i < levels.size(); i++) {
+                bench(kernel, width, levels[i], i == 0);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+/**
+ * bitpack.hpp
+ * 
+ * Conversion between one cell per byte and 32 cells per 32-bit word, where
+ * cell i is bit i % 32 of word i / 32. Used wherever worlds are moved or 
+ * stored bit-packed to save memory and bandwidth.
+ * 
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __BITPACK_HPP__
+#define __BITPACK_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <x86intrin.h>
+
+/* Packs count cells into count / 32 words. count must be a multiple of 32. */
+static inline void pack_cells(const char* cells, uint32_t* bits, size_t count)
+{
+    for (size_t i = 0; i < count; i += 32) {
+        // Cells are 0 or 1, shifting them to the sign bit lets movemask 
+        // gather 16 of them at a time.
+        __m128i lo = _mm_slli_epi16(_mm_loadu_si128((__m128i*)(cells + i)), 7);
+        __m128i hi = _mm_slli_epi16(_mm_loadu_si128((__m128i*)(cells + i + 16)), 7);
+        bits[i / 32] = (uint32_t)_mm_movemask_epi8(lo) | ((uint32_t)_mm_movemask_epi8(hi) << 16);
+    }
+}
+
+/* Unpacks count / 32 words into count cells. count must be a multiple of 32. */
+static inline void unpack_cells(const uint32_t* bits, char* cells, size_t count)
+{
+    for (size_t i = 0; i < count; i += 8) {
+        // Copies the byte into every byte of a 64-bit integer, keeps bit j in
+        // byte j, then turns every nonzero byte into 1.
+        uint64_t spread = (bits[i / 32] >> (i % 32)) & 0xFF;
+        spread = (spread * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+        spread = ((spread + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+        memcpy(cells + i, &spread, 8);
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * change_stream.hpp
+ *
+ * Cells that changed in every generation of a simulation, for consumers that
+ * follow a world without a copy of every generation. An entry is a run of 16
+ * cells of the row-major world with a bit for every cell of it that changed,
+ * the index of the first cell in the upper 48 bits and the bits in the lower
+ * 16, cell i + b in bit b. Runs with no changed cell have no entry, so a
+ * world with little activity takes a few entries per generation instead of a
+ * byte per cell.
+ *
+ * Engines XOR every vector of the next generation with the one before while
+ * it is still in a register, so finding the changes costs no extra pass over
+ * the world. Entries of a generation are in order of their first cell.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __CHANGE_STREAM_HPP__
+#define __CHANGE_STREAM_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Returns the entry of the run of 16 cells starting at cell with changed
+bits. */
+static inline uint64_t change_entry(size_t cell, unsigned changed)
+{
+    return (uint64_t)cell << 16 | changed;
+}
+
+static inline size_t change_entry_cell(uint64_t entry)
+{
+    return entry >> 16;
+}
+
+static inline unsigned change_entry_bits(uint64_t entry)
+{
+    return entry & 0xffff;
+}
+
+class change_stream
+{
+private:
+    // Entries of every generation one after the other, and the end of the
+    // entries of every generation.
+    std::vector<uint64_t> _entries;
+    std::vector<size_t> _ends;
+
+public:
+    inline size_t generations() const { return _ends.size(); };
+
+    /* Entries of generation gen, the first generation after the world given
+    to the engine is 0. */
+    inline const uint64_t* begin(size_t gen) const { return _entries.data() + (gen ? _ends[gen - 1] : 0); };
+    inline const uint64_t* end(size_t gen) const { return _entries.data() + _ends[gen]; };
+    inline size_t size(size_t gen) const { return end(gen) - begin(gen); };
+
+    /* Bytes of entries of every generation. */
+    inline size_t bytes() const { return _entries.size() * sizeof(uint64_t); };
+
+    /* Adds a generation of count entries and returns them to fill in. */
+    uint64_t* append(size_t count);
+
+    /* Removes every generation. */
+    void clear();
+
+    /* Toggles the cells that changed in generation gen of a world, which
+    turns generation gen - 1 into gen. */
+    void apply(char* grid, size_t gen) const;
+};
+
+/* Multi-threaded CPU SIMD with OpenMP that appends the changes of every
+generation to changes. Every thread keeps the entries of its band, which are
+merged in band order at the end of every generation. */
+void cpu_omp_changes(char* grid, int width, int height, int gens, change_stream& changes);
+
+/* GPU with OpenCL that appends the changes of every generation to changes.
+Only the entries are copied back every generation, in no particular order,
+and are sorted on the host. Width must be a power of 2 greater than 16. */
+void gpu_ocl_changes(char* grid, int width, int height, int gens, change_stream& changes);
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * cow_world.hpp
+ *
+ * Copy-on-write worlds of tile_dim x tile_dim tiles, for forking a world into
+ * many variants. A copy of a world shares every tile with it by reference
+ * count, and a tile is only copied when a world that shares it edits it, so
+ * forks cost memory and copy time for the tiles they differ in only.
+ *
+ * Worlds are simulated a generation at a time by tile_next(). Worlds stepped
+ * together share the next generation of every tile whose neighborhood is the
+ * same tiles in each of them, so a tile that no fork has changed is computed
+ * once for all forks and stays shared. Tiles with no alive cells are all one
+ * shared empty tile, which is never computed.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __COW_WORLD_HPP__
+#define __COW_WORLD_HPP__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <cpu_tiled.hpp>
+
+/* Tile of a copy-on-write world, never changed while it is shared. */
+struct cow_tile
+{
+    char* cells;
+
+    cow_tile();
+    ~cow_tile();
+
+    cow_tile(const cow_tile&) = delete;
+    cow_tile& operator=(const cow_tile&) = delete;
+};
+
+/* World with width and height that are multiples of tile_dim. Copying a world
+forks it. A world is used by one thread at a time, but forks of it may be used
+by other threads meanwhile. */
+class cow_world
+{
+private:
+    int _width;
+    int _height;
+    int _tiles_x;
+    int _tiles_y;
+
+    // Tiles in row-major order of the tile grid.
+    std::vector<std::shared_ptr<cow_tile>> _tiles;
+
+    /* Returns tile t to change, copied first if it is shared. */
+    cow_tile* writable_tile(int t);
+
+public:
+    /* Copies a row-major world. */
+    cow_world(const char* grid, int width, int height);
+
+    inline int width() const { return _width; };
+    inline int height() const { return _height; };
+
+    bool cell(int x, int y) const;
+    void set_cell(int x, int y, bool alive);
+
+    /* Copies the world to row-major order. */
+    void to_rows(char* grid) const;
+
+    /* Simulates the world gens generations. */
+    void step(int gens);
+
+    /* Simulates worlds gens generations together, every tile of the next
+    generation is computed once for all the worlds it has the same
+    neighborhood in. */
+    static void step(const std::vector<cow_world*>& worlds, int gens);
+
+    /* Returns the number of distinct tiles with alive cells held by worlds,
+    which use that many times tile_size bytes of cells together. */
+    static size_t distinct_tiles(const std::vector<const cow_world*>& worlds);
+};
+
+#endif
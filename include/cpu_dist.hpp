@@ -0,0 +1,86 @@
+/**
+ * cpu_dist.hpp
+ *
+ * Distributed-memory Game of Life. The band decomposition of cpu_omp extended
+ * across processes, where every process owns a band of rows and exchanges
+ * ghost rows with the processes that own the bands north and south of it.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __CPU_DIST_HPP__
+#define __CPU_DIST_HPP__
+
+#include <functional>
+
+/* Moves ghost rows between a process and its north and south neighbors. Bands
+are arranged in a ring, so the north neighbor of rank 0 is the last rank. */
+class dist_transport
+{
+public:
+    virtual ~dist_transport() {};
+
+    virtual int rank() const = 0;
+    virtual int size() const = 0;
+
+    /* Sends north_out to the north neighbor and south_out to the south
+    neighbor. Receives the south_out of the north neighbor into north_in and
+    the north_out of the south neighbor into south_in. */
+    virtual void exchange(const char* north_out, const char* south_out, char* north_in, char* south_in,
+        int bytes) = 0;
+};
+
+/* Processes on the same machine connected in a ring by UNIX sockets. */
+class dist_transport_socket : public dist_transport
+{
+private:
+    int _rank;
+    int _size;
+    int _fd_north;
+    int _fd_south;
+
+public:
+    dist_transport_socket(int rank, int size, int fd_north, int fd_south);
+    ~dist_transport_socket();
+
+    int rank() const { return _rank; };
+    int size() const { return _size; };
+    void exchange(const char* north_out, const char* south_out, char* north_in, char* south_in, int bytes);
+};
+
+#ifdef GOL_HAVE_MPI
+/* Processes in MPI_COMM_WORLD, where the rank in the ring is the MPI rank.
+Initializes MPI if the caller has not already, and then finalizes it once at
+process exit. */
+class dist_transport_mpi : public dist_transport
+{
+private:
+    int _rank;
+    int _size;
+
+public:
+    dist_transport_mpi();
+
+    int rank() const { return _rank; };
+    int size() const { return _size; };
+    void exchange(const char* north_out, const char* south_out, char* north_in, char* south_in, int bytes);
+};
+#endif
+
+/* Returns the first row and number of rows of the band owned by rank. */
+void dist_band(int height, int size, int rank, int* y_start, int* rows);
+
+/* Forks procs - 1 child processes connected in a ring by UNIX sockets and
+runs func in every process, including the caller as rank 0. Returns after
+every child has exited, throws if any of them failed. */
+void dist_spawn_local(int procs, const std::function<void(dist_transport&)>& func);
+
+/* Simulates the band owned by this process. band holds band_height rows of
+width cells. Ghost rows are exchanged every halo generations, with halo rows
+from each neighbor, so every band must have at least halo rows. */
+void cpu_dist(char* band, int width, int band_height, int gens, dist_transport& transport, int halo = 1);
+
+/* Simulates a whole world with procs processes on this machine. */
+void cpu_dist_local(char* grid, int width, int height, int gens, int procs, int halo = 1);
+
+#endif
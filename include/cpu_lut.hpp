@@ -0,0 +1,50 @@
+/**
+ * cpu_lut.hpp
+ *
+ * Game of Life with a lookup table instead of counting neighbors. The world is
+ * encoded as 2x2 blocks of cells, one block per byte. Four neighboring blocks
+ * form a 4x4 neighborhood, which the table maps to the next states of the
+ * 2x2 cells in its center.
+ *
+ * The center of the four blocks is offset by one cell from the blocks, so
+ * every generation moves the block grid one cell diagonally. Even generations
+ * have blocks at even cells, odd generations at odd cells, so a sweep only
+ * ever reads four blocks per output block.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __CPU_LUT_HPP__
+#define __CPU_LUT_HPP__
+
+#include <cstdint>
+
+// Entries in a table, one for every 4x4 neighborhood.
+const int lut_table_size = 65536;
+
+/* Parses a rule in B/S notation, e.g. "B3/S23" for Conway's Game of Life, into
+masks where bit n is set if a cell with n neighbors is born or survives. */
+void lut_parse_rule(const char* rule, int* birth_mask, int* survive_mask);
+
+/* Fills table with lut_table_size entries for the given rule. The index of an
+entry is the northwest, northeast, southwest and southeast blocks of the
+neighborhood, four bits each from the lowest. */
+void lut_build_table(uint8_t* table, int birth_mask, int survive_mask);
+
+/* Encodes a world with even width and height into width / 2 x height / 2
+blocks. Bits 0 to 3 of a block are its northwest, northeast, southwest and
+southeast cells. */
+void lut_encode(const char* grid, uint8_t* blocks, int width, int height);
+
+/* Decodes blocks to a world. If phase is 1, the blocks start one cell south
+and east of the world, as after an odd number of generations. */
+void lut_decode(const uint8_t* blocks, char* grid, int width, int height, int phase);
+
+/* Simulates blocks encoded with lut_encode for gens generations with table.
+Returns the phase of the result for lut_decode. */
+int cpu_lut_blocks(uint8_t* blocks, int width, int height, int gens, const uint8_t* table);
+
+/* Simulates a world with even width and height for any rule in B/S notation. */
+void cpu_lut_rule(char* grid, int width, int height, int gens, const char* rule);
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * cpu_ooc.hpp
+ *
+ * Out-of-core Game of Life for worlds larger than memory. The world lives in
+ * a file, bit-packed as in bitpack.hpp with every row starting on a word, and
+ * only a band of rows padded with halo ghost rows on each side is in memory
+ * at a time. Every pass over the file advances every band halo generations,
+ * so the file is read and written once per halo generations.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __CPU_OOC_HPP__
+#define __CPU_OOC_HPP__
+
+#include <cstddef>
+
+// Generations per pass over the file, also the number of ghost rows on each
+// side of a band.
+const int ooc_halo = 16;
+
+/* Writes a world to a file in the out-of-core format. Width must be a
+multiple of 32. */
+void ooc_write_world(const char* path, const char* grid, int width, int height);
+
+/* Reads a world from a file in the out-of-core format. Width must be a
+multiple of 32. */
+void ooc_read_world(const char* path, char* grid, int width, int height);
+
+/* Returns the most rows a band can have for the buffers of a pass to fit in
+memory bytes. Throws if not even a band of one row fits. */
+int ooc_band_rows(int width, int halo, size_t memory);
+
+/* Simulates the world in the file at path in place, with at most memory bytes
+of buffers. The next generation of every pass is written to path with
+".next" appended, which replaces the file at path if it holds the result. */
+void cpu_ooc_file(const char* path, int width, int height, int gens, size_t memory, int halo = ooc_halo);
+
+/* Simulates a world through a temporary file in $TMPDIR, or /tmp, with at
+most memory bytes of buffers. Width must be a multiple of 32. */
+void cpu_ooc(char* grid, int width, int height, int gens, size_t memory, int halo = ooc_halo);
+
+#endif
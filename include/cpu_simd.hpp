@@ -11,7 +11,10 @@
 #ifndef __CPU_SIMD_HPP__
 #define __CPU_SIMD_HPP__
 
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
+#include <string>
 #include <x86intrin.h>
 #include <util.hpp>
 
@@ -44,45 +47,46 @@ static inline T cpu_simd_int_alive(T cells, T neighbors_count)
             ~(neighbors_count >> 3) & (T)0x0101010101010101;
 }
 
-/* Processes rows with width the same size as integer type. */
+/* Processes a row with width the same size as integer type, from north, 
+current and south rows anywhere into out. */
 template <class T> 
-static inline void cpu_simd_int_row_intw(char* grid, char* buf, int y, int y_north, int y_south)
+static inline void cpu_simd_int_row_intw_at(char* p_north, char* p_row, char* p_south, char* p_out)
 {
     int vec_len = sizeof(T);
-    int width = vec_len;
-    int i_row = y * width;
-    int i_north = y_north * width;
-    int i_south = y_south * width;
 
     // East/west, northeast/northwest, southeast/southwest cells are rotations
     // of current cells, north, south cells, respectively.
-    T cells = *(T*)(grid + i_row);
-    T n_cells = *(T*)(grid + i_north);
+    T cells = *(T*)p_row;
+    T n_cells = *(T*)p_north;
     T nw_cells = (n_cells << 8) | (n_cells >> ((vec_len - 1) * 8));
     T ne_cells = (n_cells >> 8) | (n_cells << ((vec_len - 1) * 8));
     T w_cells = (cells << 8) | (cells >> ((vec_len - 1) * 8));
     T e_cells = (cells >> 8) | (cells << ((vec_len - 1) * 8));
-    T s_cells = *(T*)(grid + i_south);
+    T s_cells = *(T*)p_south;
     T sw_cells = (s_cells << 8) | (s_cells >> ((vec_len - 1) * 8));
     T se_cells = (s_cells >> 8) | (s_cells << ((vec_len - 1) * 8));
 
     T neighbors_count = n_cells + nw_cells + ne_cells + w_cells + e_cells + s_cells + sw_cells + se_cells;
     cells = cpu_simd_int_alive<T>(cells, neighbors_count);
-    *(T*)(buf + i_row) = cells;
+    *(T*)p_out = cells;
 }
 
-/* Processes rows with width size greater than integer type. */
+/* Processes rows with width the same size as integer type. */
 template <class T> 
-static inline void cpu_simd_int_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+static inline void cpu_simd_int_row_intw(char* grid, char* buf, int y, int y_north, int y_south)
 {
-    int vec_len = sizeof(T);
-    int i_row = y * width;
-    int i_north = y_north * width;
-    int i_south = y_south * width;
+    int width = sizeof(T);
+    size_t i_row = (size_t)y * width;
+    cpu_simd_int_row_intw_at<T>(grid + (size_t)y_north * width, grid + i_row, grid + (size_t)y_south * width, 
+        buf + i_row);
+}
 
-    char* p_north = grid + i_north;
-    char* p_row = grid + i_row;
-    char* p_south = grid + i_south;
+/* Processes a row with width size greater than integer type, from north, 
+current and south rows anywhere into out. */
+template <class T> 
+static inline void cpu_simd_int_row_at(char* p_north, char* p_row, char* p_south, char* p_out, int width)
+{
+    int vec_len = sizeof(T);
 
     // First vector is a special case because the west neighbors wrap around. 
     // To access the west, northwest, southwest cells, the current cells, north, 
@@ -100,7 +104,7 @@ static inline void cpu_simd_int_row(char* grid, char* buf, int width, int y, int
 
     T neighbors_count = n_cells + nw_cells + ne_cells + w_cells + e_cells + s_cells + sw_cells + se_cells;
     cells = cpu_simd_int_alive<T>(cells, neighbors_count);
-    *(T*)(buf + i_row) = cells;
+    *(T*)p_out = cells;
 
     // Middle vectors
     for (int x = vec_len; x < width - vec_len; x += vec_len) {
@@ -119,7 +123,7 @@ static inline void cpu_simd_int_row(char* grid, char* buf, int width, int y, int
 
         neighbors_count = n_cells + nw_cells + ne_cells + w_cells + e_cells + s_cells + sw_cells + se_cells;
         cells = cpu_simd_int_alive<T>(cells, neighbors_count);
-        *(T*)(buf + i_row + x) = cells;
+        *(T*)(p_out + x) = cells;
     }
 
     // Last vector is a special case because the east neighbors wrap around. 
@@ -138,7 +142,16 @@ static inline void cpu_simd_int_row(char* grid, char* buf, int width, int y, int
 
     neighbors_count = n_cells + nw_cells + ne_cells + w_cells + e_cells + s_cells + sw_cells + se_cells;
     cells = cpu_simd_int_alive<T>(cells, neighbors_count);
-    *(T*)(buf + i_row + width - vec_len) = cells;
+    *(T*)(p_out + width - vec_len) = cells;
+}
+
+/* Processes rows with width size greater than integer type. */
+template <class T> 
+static inline void cpu_simd_int_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+{
+    size_t i_row = (size_t)y * width;
+    cpu_simd_int_row_at<T>(grid + (size_t)y_north * width, grid + i_row, grid + (size_t)y_south * width, 
+        buf + i_row, width);
 }
 
 /* Processes n cells simultaneously, where n is the size of T. */
@@ -149,7 +162,7 @@ void cpu_simd_int(char* grid, int width, int height, int gens)
     if (width < vec_len) {
         throw std::invalid_argument("width must be at least " + std::to_string(vec_len));
     }
-    int size = width * height;
+    size_t size = (size_t)width * height;
     char* buf = new char[size];
 
     /* Grids with the same width as the size of the specified integer type T 
@@ -212,24 +225,20 @@ static inline __m128i cpu_simd_16_alive(__m128i cells, __m128i neighbors_count)
 }
 #endif
 
-/* Processes rows with exactly 16 width. */
-static inline void cpu_simd_16_row_16w(char* grid, char* buf, int y, int y_north, int y_south)
+/* Processes a row with exactly 16 width, from north, current and south rows 
+aligned to 16 bytes anywhere into out. */
+static inline void cpu_simd_16_row_16w_at(char* p_north, char* p_row, char* p_south, char* p_out)
 {
 #if defined __SSE2__ && defined __SSSE3__
-    int width = 16;
-    int i_row = y * width;
-    int i_north = y_north * width;
-    int i_south = y_south * width;
-
     // East/west, northeast/northwest, southeast/southwest cells are rotations
     // of current cells, north, south cells, respectively.
-    __m128i cells = _mm_load_si128((__m128i*)(grid + i_row));
-    __m128i n_cells = _mm_load_si128((__m128i*)(grid + i_north));
+    __m128i cells = _mm_load_si128((__m128i*)p_row);
+    __m128i n_cells = _mm_load_si128((__m128i*)p_north);
     __m128i ne_cells = _mm_alignr_epi8(n_cells, n_cells, 1);
     __m128i nw_cells = _mm_alignr_epi8(n_cells, n_cells, 15);
     __m128i e_cells = _mm_alignr_epi8(cells, cells, 1);
     __m128i w_cells = _mm_alignr_epi8(cells, cells, 15);
-    __m128i s_cells = _mm_load_si128((__m128i*)(grid + i_south));
+    __m128i s_cells = _mm_load_si128((__m128i*)p_south);
     __m128i se_cells = _mm_alignr_epi8(s_cells, s_cells, 1);
     __m128i sw_cells = _mm_alignr_epi8(s_cells, s_cells, 15);
 
@@ -243,25 +252,24 @@ static inline void cpu_simd_16_row_16w(char* grid, char* buf, int y, int y_north
     neighbors_count = _mm_add_epi8(neighbors_count, sw_cells);
 
     cells = cpu_simd_16_alive(cells, neighbors_count);
-    _mm_store_si128((__m128i*)(buf + i_row), cells);
+    _mm_store_si128((__m128i*)p_out, cells);
 #else
-    cpu_simd_int_row<uint64_t>(grid, buf, 16, y, y_north, y_south);
+    cpu_simd_int_row_at<uint64_t>(p_north, p_row, p_south, p_out, 16);
 #endif
 }
 
-/* Processes a row with greater than 16 width. */
-static inline void cpu_simd_16_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+/* Processes rows with exactly 16 width. */
+static inline void cpu_simd_16_row_16w(char* grid, char* buf, int y, int y_north, int y_south)
 {
-#if defined __SSE2__ && defined __SSSE3__
-    int i_row = y * width;
-    int i_north = y_north * width;
-    int i_south = y_south * width;
-
-    // Pointers to the start of the north, current, and south rows
-    char* p_north = grid + i_north;
-    char* p_row = grid + i_row;
-    char* p_south = grid + i_south;
+    size_t i_row = (size_t)y * 16;
+    cpu_simd_16_row_16w_at(grid + (size_t)y_north * 16, grid + i_row, grid + (size_t)y_south * 16, buf + i_row);
+}
 
+/* Processes a row with greater than 16 width, from north, current and south 
+rows anywhere into out. */
+static inline void cpu_simd_16_row_at(char* p_north, char* p_row, char* p_south, char* p_out, int width)
+{
+#if defined __SSE2__ && defined __SSSE3__
     // First vector is a special case because the west neighbors wrap around. 
     // To access the west, northwest, southwest cells, the current cells, north, 
     // south cells, repectively, are left shifted one and the first vector 
@@ -287,7 +295,7 @@ static inline void cpu_simd_16_row(char* grid, char* buf, int width, int y, int
     neighbors_count = _mm_add_epi8(neighbors_count, sw_cells);
 
     cells = cpu_simd_16_alive(cells, neighbors_count);
-    _mm_storeu_si128((__m128i*)(buf + i_row), cells);
+    _mm_storeu_si128((__m128i*)p_out, cells);
 
     // Middle vectors
     for (int x = 16; x < width - 16; x += 16) {
@@ -314,7 +322,7 @@ static inline void cpu_simd_16_row(char* grid, char* buf, int width, int y, int
         neighbors_count = _mm_add_epi8(neighbors_count, sw_cells);
 
         cells = cpu_simd_16_alive(cells, neighbors_count);
-        _mm_storeu_si128((__m128i*)(buf + i_row + x), cells);
+        _mm_storeu_si128((__m128i*)(p_out + x), cells);
     }
 
     // Last vector is a special case because the east neighbors wrap around. 
@@ -341,10 +349,583 @@ static inline void cpu_simd_16_row(char* grid, char* buf, int width, int y, int
     neighbors_count = _mm_add_epi8(neighbors_count, se_cells);
 
     cells = cpu_simd_16_alive(cells, neighbors_count);
-    _mm_storeu_si128((__m128i*)(buf + i_row + width - 16), cells);
+    _mm_storeu_si128((__m128i*)(p_out + width - 16), cells);
+#else
+    cpu_simd_int_row_at<uint64_t>(p_north, p_row, p_south, p_out, width);
+#endif
+}
+
+/* Processes a row with greater than 16 width. */
+static inline void cpu_simd_16_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+{
+    size_t i_row = (size_t)y * width;
+    cpu_simd_16_row_at(grid + (size_t)y_north * width, grid + i_row, grid + (size_t)y_south * width, buf + i_row, 
+        width);
+}
+
+#if defined __SSE2__ && defined __SSSE3__
+/* Calculates the next states of the first 16 cells of a row. */
+static inline __m128i cpu_simd_16_vec_first(char* p_north, char* p_row, char* p_south, int width)
+{
+    __m128i cells = _mm_loadu_si128((__m128i*)(p_row));
+    __m128i n_cells = _mm_loadu_si128((__m128i*)(p_north));
+    __m128i s_cells = _mm_loadu_si128((__m128i*)(p_south));
+    __m128i neighbors_count = n_cells;
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_north + 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, shift_in_first_16(n_cells, p_north[width - 1]));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_row + 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, shift_in_first_16(cells, p_row[width - 1]));
+    neighbors_count = _mm_add_epi8(neighbors_count, s_cells);
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_south + 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, shift_in_first_16(s_cells, p_south[width - 1]));
+    return cpu_simd_16_alive(cells, neighbors_count);
+}
+
+/* Calculates the next states of 16 cells that are not the first or last. */
+static inline __m128i cpu_simd_16_vec_middle(char* p_north, char* p_row, char* p_south, int x)
+{
+    __m128i cells = _mm_loadu_si128((__m128i*)(p_row + x));
+    __m128i neighbors_count = _mm_loadu_si128((__m128i*)(p_north + x));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_north + x - 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_north + x + 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_row + x - 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_row + x + 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_south + x)));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_south + x - 1)));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_south + x + 1)));
+    return cpu_simd_16_alive(cells, neighbors_count);
+}
+
+/* Calculates the next states of the last 16 cells of a row. */
+static inline __m128i cpu_simd_16_vec_last(char* p_north, char* p_row, char* p_south, int width)
+{
+    __m128i cells = _mm_loadu_si128((__m128i*)(p_row + width - 16));
+    __m128i n_cells = _mm_loadu_si128((__m128i*)(p_north + width - 16));
+    __m128i s_cells = _mm_loadu_si128((__m128i*)(p_south + width - 16));
+    __m128i neighbors_count = n_cells;
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_north + width - 17)));
+    neighbors_count = _mm_add_epi8(neighbors_count, shift_in_last_16(n_cells, *p_north));
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_row + width - 17)));
+    neighbors_count = _mm_add_epi8(neighbors_count, shift_in_last_16(cells, *p_row));
+    neighbors_count = _mm_add_epi8(neighbors_count, s_cells);
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_loadu_si128((__m128i*)(p_south + width - 17)));
+    neighbors_count = _mm_add_epi8(neighbors_count, shift_in_last_16(s_cells, *p_south));
+    return cpu_simd_16_alive(cells, neighbors_count);
+}
+#endif
+
+/* Processes the cells from x_start to x_end of a row with greater than 16 
+width. The span must be at least 16 cells unless it is the whole row. Vectors
+that would cross x_end are moved back to end at x_end, so cells are never 
+written outside of the span. */
+static inline void cpu_simd_16_row_span(char* grid, char* buf, int width, int y, int y_north, int y_south, 
+    int x_start, int x_end)
+{
+#if defined __SSE2__ && defined __SSSE3__
+    char* p_north = grid + (size_t)y_north * width;
+    char* p_row = grid + (size_t)y * width;
+    char* p_south = grid + (size_t)y_south * width;
+    char* p_buf = buf + (size_t)y * width;
+
+    int x = x_start;
+    if (!x) {
+        _mm_storeu_si128((__m128i*)p_buf, cpu_simd_16_vec_first(p_north, p_row, p_south, width));
+        x = 16;
+    }
+    for (; x + 16 <= x_end && x < width - 16; x += 16) {
+        _mm_storeu_si128((__m128i*)(p_buf + x), cpu_simd_16_vec_middle(p_north, p_row, p_south, x));
+    }
+    if (x < x_end) {
+        x = x_end - 16;
+        if (x_end == width) {
+            _mm_storeu_si128((__m128i*)(p_buf + x), cpu_simd_16_vec_last(p_north, p_row, p_south, width));
+        }
+        else {
+            _mm_storeu_si128((__m128i*)(p_buf + x), cpu_simd_16_vec_middle(p_north, p_row, p_south, x));
+        }
+    }
+#else
+    // Cell by cell, since an integer vector row would write outside the span.
+    char* p_north = grid + (size_t)y_north * width;
+    char* p_row = grid + (size_t)y * width;
+    char* p_south = grid + (size_t)y_south * width;
+    char* p_buf = buf + (size_t)y * width;
+    for (int x = x_start; x < x_end; x++) {
+        int x_west = x ? x - 1 : width - 1;
+        int x_east = x < width - 1 ? x + 1 : 0;
+        char cell = p_north[x_west] + p_north[x] + p_north[x_east] + p_row[x_west] + p_row[x_east] + 
+                    p_south[x_west] + p_south[x] + p_south[x_east];
+        p_buf[x] = (cell == 3) | ((cell == 2) & p_row[x]);
+    }
+#endif
+}
+
+/*******************************************************************************
+ * CPU SIMD any width
+ ******************************************************************************/
+
+/* Processes a row of any width with the widest vector that does not overrun 
+it. Used by engines that process rows one at a time without knowing the width 
+class in advance. */
+static inline void cpu_simd_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+{
+    if (width > 16) {
+        cpu_simd_16_row(grid, buf, width, y, y_north, y_south);
+    }
+    else if (width == 16) {
+        cpu_simd_16_row_16w(grid, buf, y, y_north, y_south);
+    }
+    else if (width > 8) {
+        cpu_simd_int_row<uint64_t>(grid, buf, width, y, y_north, y_south);
+    }
+    else if (width == 8) {
+        cpu_simd_int_row_intw<uint64_t>(grid, buf, y, y_north, y_south);
+    }
+    else if (width > 4) {
+        cpu_simd_int_row<uint32_t>(grid, buf, width, y, y_north, y_south);
+    }
+    else if (width == 4) {
+        cpu_simd_int_row_intw<uint32_t>(grid, buf, y, y_north, y_south);
+    }
+    else if (width > 2) {
+        cpu_simd_int_row<uint16_t>(grid, buf, width, y, y_north, y_south);
+    }
+    else if (width == 2) {
+        cpu_simd_int_row_intw<uint16_t>(grid, buf, y, y_north, y_south);
+    }
+    else {
+        cpu_simd_int_row_intw<uint8_t>(grid, buf, y, y_north, y_south);
+    }
+}
+
+/* Processes a row of any width like cpu_simd_row(), from north, current and 
+south rows anywhere into out. Rows of 16 width must be aligned to 16 bytes. */
+static inline void cpu_simd_row_at(char* p_north, char* p_row, char* p_south, char* p_out, int width)
+{
+    if (width > 16) {
+        cpu_simd_16_row_at(p_north, p_row, p_south, p_out, width);
+    }
+    else if (width == 16) {
+        cpu_simd_16_row_16w_at(p_north, p_row, p_south, p_out);
+    }
+    else if (width > 8) {
+        cpu_simd_int_row_at<uint64_t>(p_north, p_row, p_south, p_out, width);
+    }
+    else if (width == 8) {
+        cpu_simd_int_row_intw_at<uint64_t>(p_north, p_row, p_south, p_out);
+    }
+    else if (width > 4) {
+        cpu_simd_int_row_at<uint32_t>(p_north, p_row, p_south, p_out, width);
+    }
+    else if (width == 4) {
+        cpu_simd_int_row_intw_at<uint32_t>(p_north, p_row, p_south, p_out);
+    }
+    else if (width > 2) {
+        cpu_simd_int_row_at<uint16_t>(p_north, p_row, p_south, p_out, width);
+    }
+    else if (width == 2) {
+        cpu_simd_int_row_intw_at<uint16_t>(p_north, p_row, p_south, p_out);
+    }
+    else {
+        cpu_simd_int_row_intw_at<uint8_t>(p_north, p_row, p_south, p_out);
+    }
+}
+
+/*******************************************************************************
+ * CPU SIMD fixed width
+ * 
+ * Rows of a width known at compile time. Every vector of the north, current
+ * and south rows is loaded once and summed vertically, and the column sums are
+ * kept in registers until the vectors east of them have been processed. The
+ * neighbor count of a cell is the column sums west of it, of it and east of
+ * it minus the cell itself, where the west and east column sums are shifted in
+ * from the vectors next to it instead of loaded again unaligned. The column 
+ * loop is unrolled completely, so the wraparound of the first and last vectors
+ * to the other end of the row costs nothing.
+ ******************************************************************************/
+
+/* Processes rows of width W, a multiple of the size of T greater than it. */
+template <class T, int W>
+static inline void cpu_simd_int_row_fixed(char* grid, char* buf, int y, int y_north, int y_south)
+{
+    const int vec_len = sizeof(T);
+    const int vecs = W / vec_len;
+    const int carry = (vec_len - 1) * 8;
+    char* p_north = grid + (size_t)y_north * W;
+    char* p_row = grid + (size_t)y * W;
+    char* p_south = grid + (size_t)y_south * W;
+    char* p_buf = buf + (size_t)y * W;
+
+    // Column sums are at most 3, so the sum of three of them never carries
+    // into the next byte. The first column sums are east of the last ones,
+    // the last column sums are west of the first ones.
+    T first = *(T*)p_row;
+    T col_first = *(T*)p_north + first + *(T*)p_south;
+    T col_west = *(T*)(p_north + W - vec_len) + *(T*)(p_row + W - vec_len) + *(T*)(p_south + W - vec_len);
+    T cells = first;
+    T col = col_first;
+
+    #pragma GCC unroll 32
+    for (int v = 0; v < vecs; v++) {
+        int x_east = (v + 1) * vec_len;
+        T east = v + 1 < vecs ? *(T*)(p_row + x_east) : first;
+        T col_east = v + 1 < vecs ? *(T*)(p_north + x_east) + east + *(T*)(p_south + x_east) : col_first;
+
+        T neighbors_count = (col << 8 | col_west >> carry) + col + (col >> 8 | col_east << carry) - cells;
+        *(T*)(p_buf + v * vec_len) = cpu_simd_int_alive<T>(cells, neighbors_count);
+
+        col_west = col;
+        col = col_east;
+        cells = east;
+    }
+}
+
+/* Processes rows of width W, a multiple of 16 greater than 16. */
+template <int W>
+static inline void cpu_simd_16_row_fixed(char* grid, char* buf, int y, int y_north, int y_south)
+{
+#if defined __SSE2__ && defined __SSSE3__
+    const int vecs = W / 16;
+    char* p_north = grid + (size_t)y_north * W;
+    char* p_row = grid + (size_t)y * W;
+    char* p_south = grid + (size_t)y_south * W;
+    char* p_buf = buf + (size_t)y * W;
+
+    // The first column sums are east of the last ones, the last column sums
+    // are west of the first ones.
+    __m128i first = _mm_loadu_si128((__m128i*)p_row);
+    __m128i col_first = _mm_add_epi8(_mm_add_epi8(_mm_loadu_si128((__m128i*)p_north), first), 
+        _mm_loadu_si128((__m128i*)p_south));
+    __m128i col_west = _mm_add_epi8(_mm_add_epi8(_mm_loadu_si128((__m128i*)(p_north + W - 16)), 
+        _mm_loadu_si128((__m128i*)(p_row + W - 16))), _mm_loadu_si128((__m128i*)(p_south + W - 16)));
+    __m128i cells = first;
+    __m128i col = col_first;
+
+    #pragma GCC unroll 16
+    for (int v = 0; v < vecs; v++) {
+        int x_east = (v + 1) * 16;
+        __m128i east = v + 1 < vecs ? _mm_loadu_si128((__m128i*)(p_row + x_east)) : first;
+        __m128i col_east = v + 1 < vecs ? _mm_add_epi8(_mm_add_epi8(_mm_loadu_si128((__m128i*)(p_north + x_east)), 
+            east), _mm_loadu_si128((__m128i*)(p_south + x_east))) : col_first;
+
+        // The last column sum of the vector west of a vector is shifted in as
+        // the west column sum of its first cell, the first column sum of the
+        // vector east of it as the east column sum of its last cell.
+        __m128i neighbors_count = _mm_add_epi8(_mm_alignr_epi8(col, col_west, 15), col);
+        neighbors_count = _mm_add_epi8(neighbors_count, _mm_alignr_epi8(col_east, col, 1));
+        neighbors_count = _mm_sub_epi8(neighbors_count, cells);
+        _mm_storeu_si128((__m128i*)(p_buf + v * 16), cpu_simd_16_alive(cells, neighbors_count));
+
+        col_west = col;
+        col = col_east;
+        cells = east;
+    }
 #else
-    cpu_simd_int_row<uint64_t>(grid, buf, width, y, y_north, y_south);
+    cpu_simd_int_row_fixed<uint64_t, W>(grid, buf, y, y_north, y_south);
 #endif
 }
 
+/* Processes rows with exactly 24 width, as two vectors that overlap by 8 
+cells. Both compute the same next states for the cells they share. */
+static inline void cpu_simd_16_row_24w(char* grid, char* buf, int y, int y_north, int y_south)
+{
+#if defined __SSE2__ && defined __SSSE3__
+    const int width = 24;
+    char* p_north = grid + (size_t)y_north * width;
+    char* p_row = grid + (size_t)y * width;
+    char* p_south = grid + (size_t)y_south * width;
+    char* p_buf = buf + (size_t)y * width;
+
+    // Cells 0 to 15 and 8 to 23 and their column sums.
+    __m128i cells_lo = _mm_loadu_si128((__m128i*)p_row);
+    __m128i cells_hi = _mm_loadu_si128((__m128i*)(p_row + 8));
+    __m128i col_lo = _mm_add_epi8(_mm_add_epi8(_mm_loadu_si128((__m128i*)p_north), cells_lo), 
+        _mm_loadu_si128((__m128i*)p_south));
+    __m128i col_hi = _mm_add_epi8(_mm_add_epi8(_mm_loadu_si128((__m128i*)(p_north + 8)), cells_hi), 
+        _mm_loadu_si128((__m128i*)(p_south + 8)));
+
+    // West of cell 0 is cell 23, the last of the high vector, and east of cell
+    // 15 is cell 16, the middle of the high vector. West of cell 8 is cell 7,
+    // the middle of the low vector, and east of cell 23 is cell 0.
+    __m128i neighbors_count = _mm_add_epi8(_mm_alignr_epi8(col_lo, col_hi, 15), col_lo);
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_alignr_epi8(_mm_srli_si128(col_hi, 8), col_lo, 1));
+    neighbors_count = _mm_sub_epi8(neighbors_count, cells_lo);
+    __m128i next_lo = cpu_simd_16_alive(cells_lo, neighbors_count);
+
+    neighbors_count = _mm_add_epi8(_mm_alignr_epi8(col_hi, _mm_slli_si128(col_lo, 8), 15), col_hi);
+    neighbors_count = _mm_add_epi8(neighbors_count, _mm_alignr_epi8(col_lo, col_hi, 1));
+    neighbors_count = _mm_sub_epi8(neighbors_count, cells_hi);
+    __m128i next_hi = cpu_simd_16_alive(cells_hi, neighbors_count);
+
+    _mm_storeu_si128((__m128i*)p_buf, next_lo);
+    _mm_storeu_si128((__m128i*)(p_buf + 8), next_hi);
+#else
+    cpu_simd_int_row_fixed<uint64_t, 24>(grid, buf, y, y_north, y_south);
+#endif
+}
+
+typedef void (*cpu_simd_fixed_row_t)(char* grid, char* buf, int y, int y_north, int y_south);
+typedef void (*cpu_simd_fixed_rows_t)(char* grid, char* buf, int height, int y_start, int y_end);
+
+/* Processes rows y_start to y_end of a world with a row kernel of fixed 
+width. */
+template <cpu_simd_fixed_row_t row>
+static void cpu_simd_fixed_rows(char* grid, char* buf, int height, int y_start, int y_end)
+{
+    for (int y = y_start; y < y_end; y++) {
+        row(grid, buf, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+    }
+}
+
+/* Returns the rows function for worlds of the given width, nullptr if there is
+no kernel for that width. */
+static inline cpu_simd_fixed_rows_t cpu_simd_fixed_rows_for(int width)
+{
+    switch (width) {
+        case 24:
+            return cpu_simd_fixed_rows<cpu_simd_16_row_24w>;
+        case 32:
+            return cpu_simd_fixed_rows<cpu_simd_16_row_fixed<32>>;
+        case 48:
+            return cpu_simd_fixed_rows<cpu_simd_16_row_fixed<48>>;
+        case 64:
+            return cpu_simd_fixed_rows<cpu_simd_16_row_fixed<64>>;
+        case 128:
+            return cpu_simd_fixed_rows<cpu_simd_16_row_fixed<128>>;
+        case 256:
+            return cpu_simd_fixed_rows<cpu_simd_16_row_fixed<256>>;
+        default:
+            return nullptr;
+    }
+}
+
+/*******************************************************************************
+ * CPU SIMD row-sum reuse
+ * 
+ * The kernels above load every input row three times, once for each of the 
+ * output rows it is a neighbor of, and three vectors of it each time. These 
+ * go down a column strip instead, so that the horizontal sum of every cell 
+ * and its east and west neighbors is computed once per row and kept in a 
+ * register for the next two output rows. The neighbor count of a cell is the 
+ * sum of the three horizontal sums minus the cell itself. 
+ * 
+ * Strips are only walked down a block of rows before moving to the next strip,
+ * so the rows of the block are still in L1 when the next strip reads them.
+ ******************************************************************************/
+
+// Cells per block of rows walked down by one strip before the next strip.
+static const int rowsum_block_cells = 16384;
+
+// Position of a strip in the row, which decides how east and west neighbors
+// wrap around.
+enum rowsum_strip { rowsum_middle, rowsum_first, rowsum_last, rowsum_whole };
+
+/* Returns the row number of the row south of y. */
+static inline int rowsum_south(int y, int height)
+{
+    return y + 1 == height ? 0 : y + 1;
+}
+
+/* Loads the n cells of a row starting at x, where n is the size of T, and 
+returns the sum of every cell and its east and west neighbors. */
+template <class T, rowsum_strip S>
+static inline T cpu_simd_int_hsum(char* p_row, int width, int x, T& cells)
+{
+    int vec_len = sizeof(T);
+    cells = *(T*)(p_row + x);
+    T w_cells;
+    T e_cells;
+    if (S == rowsum_whole) {
+        w_cells = (cells << 8) | (cells >> ((vec_len - 1) * 8));
+        e_cells = (cells >> 8) | (cells << ((vec_len - 1) * 8));
+    }
+    else if (S == rowsum_first) {
+        w_cells = cells << 8 | *(p_row + width - 1);
+        e_cells = *(T*)(p_row + 1);
+    }
+    else if (S == rowsum_last) {
+        w_cells = *(T*)(p_row + x - 1);
+        e_cells = cells >> 8 | ((T)(*p_row) << ((vec_len - 1) * 8));
+    }
+    else {
+        w_cells = *(T*)(p_row + x - 1);
+        e_cells = *(T*)(p_row + x + 1);
+    }
+    // Maximum sum for every byte is 3, no carry into the next byte.
+    return w_cells + cells + e_cells;
+}
+
+/* Processes the strip of n cells starting at x for rows y_start to y_end, 
+where n is the size of T. */
+template <class T, rowsum_strip S>
+static inline void cpu_simd_int_rowsum_strip(char* grid, char* buf, int width, int height, int x, 
+    int y_start, int y_end)
+{
+    T cells;
+    T s_cells;
+    T n_sum = cpu_simd_int_hsum<T, S>(grid + (size_t)(y_start ? y_start - 1 : height - 1) * width, width, x, s_cells);
+    T sum = cpu_simd_int_hsum<T, S>(grid + (size_t)y_start * width, width, x, cells);
+    for (int y = y_start; y < y_end; y++) {
+        T s_sum = cpu_simd_int_hsum<T, S>(grid + (size_t)rowsum_south(y, height) * width, width, x, s_cells);
+
+        // Every byte of the three sums is at least the cell in the middle, so
+        // the subtraction never borrows from the next byte.
+        *(T*)(buf + (size_t)y * width + x) = cpu_simd_int_alive<T>(cells, n_sum + sum + s_sum - cells);
+        n_sum = sum;
+        sum = s_sum;
+        cells = s_cells;
+    }
+}
+
+/* Processes rows y_start to y_end n cells at a time, where n is the size of T.
+Width must be at least the size of T. */
+template <class T>
+static inline void cpu_simd_int_rowsum_rows(char* grid, char* buf, int width, int height, int y_start, 
+    int y_end)
+{
+    int vec_len = sizeof(T);
+    int block_rows = std::max(1, rowsum_block_cells / width);
+    for (int y = y_start; y < y_end; y += block_rows) {
+        int y_block_end = std::min(y + block_rows, y_end);
+        if (width == vec_len) {
+            cpu_simd_int_rowsum_strip<T, rowsum_whole>(grid, buf, width, height, 0, y, y_block_end);
+            continue;
+        }
+        cpu_simd_int_rowsum_strip<T, rowsum_first>(grid, buf, width, height, 0, y, y_block_end);
+        for (int x = vec_len; x < width - vec_len; x += vec_len) {
+            cpu_simd_int_rowsum_strip<T, rowsum_middle>(grid, buf, width, height, x, y, y_block_end);
+        }
+        cpu_simd_int_rowsum_strip<T, rowsum_last>(grid, buf, width, height, width - vec_len, y, y_block_end);
+    }
+}
+
+#if defined __SSE2__ && defined __SSSE3__
+/* Loads 16 cells of a row starting at x and returns the sum of every cell and 
+its east and west neighbors. */
+template <rowsum_strip S>
+static inline __m128i cpu_simd_16_hsum(char* p_row, int width, int x, __m128i& cells)
+{
+    __m128i w_cells;
+    __m128i e_cells;
+    if (S == rowsum_whole) {
+        cells = _mm_load_si128((__m128i*)p_row);
+        w_cells = _mm_alignr_epi8(cells, cells, 15);
+        e_cells = _mm_alignr_epi8(cells, cells, 1);
+    }
+    else if (S == rowsum_first) {
+        cells = _mm_loadu_si128((__m128i*)p_row);
+        w_cells = shift_in_first_16(cells, p_row[width - 1]);
+        e_cells = _mm_loadu_si128((__m128i*)(p_row + 1));
+    }
+    else if (S == rowsum_last) {
+        cells = _mm_loadu_si128((__m128i*)(p_row + x));
+        w_cells = _mm_loadu_si128((__m128i*)(p_row + x - 1));
+        e_cells = shift_in_last_16(cells, *p_row);
+    }
+    else {
+        cells = _mm_loadu_si128((__m128i*)(p_row + x));
+        w_cells = _mm_loadu_si128((__m128i*)(p_row + x - 1));
+        e_cells = _mm_loadu_si128((__m128i*)(p_row + x + 1));
+    }
+    return _mm_add_epi8(_mm_add_epi8(w_cells, cells), e_cells);
+}
+
+/* Processes the strip of 16 cells starting at x for rows y_start to y_end. */
+template <rowsum_strip S>
+static inline void cpu_simd_16_rowsum_strip(char* grid, char* buf, int width, int height, int x, 
+    int y_start, int y_end)
+{
+    __m128i cells;
+    __m128i s_cells;
+    __m128i n_sum = cpu_simd_16_hsum<S>(grid + (size_t)(y_start ? y_start - 1 : height - 1) * width, width, x, s_cells);
+    __m128i sum = cpu_simd_16_hsum<S>(grid + (size_t)y_start * width, width, x, cells);
+    for (int y = y_start; y < y_end; y++) {
+        __m128i s_sum = cpu_simd_16_hsum<S>(grid + (size_t)rowsum_south(y, height) * width, width, x, s_cells);
+        __m128i neighbors_count = _mm_sub_epi8(_mm_add_epi8(_mm_add_epi8(n_sum, sum), s_sum), cells);
+        _mm_storeu_si128((__m128i*)(buf + (size_t)y * width + x), cpu_simd_16_alive(cells, neighbors_count));
+        n_sum = sum;
+        sum = s_sum;
+        cells = s_cells;
+    }
+}
+
+/* Processes four strips of 16 cells side by side starting at x, so every row
+stored is a whole cache line. None of them can be the first or last strip. */
+static inline void cpu_simd_16_rowsum_strip_4(char* grid, char* buf, int width, int height, int x, 
+    int y_start, int y_end)
+{
+    __m128i cells[4];
+    __m128i s_cells[4];
+    __m128i n_sum[4];
+    __m128i sum[4];
+    char* p_north = grid + (size_t)(y_start ? y_start - 1 : height - 1) * width;
+    for (int v = 0; v < 4; v++) {
+        n_sum[v] = cpu_simd_16_hsum<rowsum_middle>(p_north, width, x + v * 16, s_cells[v]);
+        sum[v] = cpu_simd_16_hsum<rowsum_middle>(grid + (size_t)y_start * width, width, x + v * 16, cells[v]);
+    }
+    for (int y = y_start; y < y_end; y++) {
+        char* p_south = grid + (size_t)rowsum_south(y, height) * width;
+        for (int v = 0; v < 4; v++) {
+            __m128i s_sum = cpu_simd_16_hsum<rowsum_middle>(p_south, width, x + v * 16, s_cells[v]);
+            __m128i neighbors_count = _mm_sub_epi8(_mm_add_epi8(_mm_add_epi8(n_sum[v], sum[v]), s_sum), 
+                cells[v]);
+            _mm_storeu_si128((__m128i*)(buf + (size_t)y * width + x + v * 16), cpu_simd_16_alive(cells[v], 
+                neighbors_count));
+            n_sum[v] = sum[v];
+            sum[v] = s_sum;
+            cells[v] = s_cells[v];
+        }
+    }
+}
+#endif
+
+/* Processes rows y_start to y_end 16 cells at a time. Width must be at least 
+16. */
+static inline void cpu_simd_16_rowsum_rows(char* grid, char* buf, int width, int height, int y_start, 
+    int y_end)
+{
+#if defined __SSE2__ && defined __SSSE3__
+    int block_rows = std::max(1, rowsum_block_cells / width);
+    for (int y = y_start; y < y_end; y += block_rows) {
+        int y_block_end = std::min(y + block_rows, y_end);
+        if (width == 16) {
+            cpu_simd_16_rowsum_strip<rowsum_whole>(grid, buf, width, height, 0, y, y_block_end);
+            continue;
+        }
+        cpu_simd_16_rowsum_strip<rowsum_first>(grid, buf, width, height, 0, y, y_block_end);
+        int x = 16;
+        for (; x + 64 <= width - 16; x += 64) {
+            cpu_simd_16_rowsum_strip_4(grid, buf, width, height, x, y, y_block_end);
+        }
+        for (; x < width - 16; x += 16) {
+            cpu_simd_16_rowsum_strip<rowsum_middle>(grid, buf, width, height, x, y, y_block_end);
+        }
+        cpu_simd_16_rowsum_strip<rowsum_last>(grid, buf, width, height, width - 16, y, y_block_end);
+    }
+#else
+    cpu_simd_int_rowsum_rows<uint64_t>(grid, buf, width, height, y_start, y_end);
+#endif
+}
+
+/* Processes rows y_start to y_end of a world of any width with the widest 
+vector that does not overrun a row. */
+static inline void cpu_simd_rowsum_rows(char* grid, char* buf, int width, int height, int y_start, int y_end)
+{
+    if (width >= 16) {
+        cpu_simd_16_rowsum_rows(grid, buf, width, height, y_start, y_end);
+    }
+    else if (width >= 8) {
+        cpu_simd_int_rowsum_rows<uint64_t>(grid, buf, width, height, y_start, y_end);
+    }
+    else if (width >= 4) {
+        cpu_simd_int_rowsum_rows<uint32_t>(grid, buf, width, height, y_start, y_end);
+    }
+    else if (width >= 2) {
+        cpu_simd_int_rowsum_rows<uint16_t>(grid, buf, width, height, y_start, y_end);
+    }
+    else {
+        cpu_simd_int_rowsum_rows<uint8_t>(grid, buf, width, height, y_start, y_end);
+    }
+}
+
 #endif
@@ -0,0 +1,227 @@
+/**
+ * cpu_stencil.hpp
+ *
+ * Life-like rule (born with 3 neighbors, survives with 2 or 3) on other
+ * neighborhoods than the 8 cells around a cell. A stencil is a mask of the
+ * cells of the 3x3 block around a cell that are its neighbors, given to the
+ * kernels as a template argument, so that the cells outside of it are never
+ * loaded or added and the kernels never branch on it.
+ *
+ * The hexagonal stencil is a hex grid stored with every row offset half a cell
+ * west of the row north of it, so the 6 neighbors of a cell are the cells
+ * west and east of it, the cell north of it and the one west of that, and the
+ * cell south of it and the one east of that. The corners ne and sw are not
+ * neighbors.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __CPU_STENCIL_HPP__
+#define __CPU_STENCIL_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <omp.h>
+#include <stdexcept>
+#include <x86intrin.h>
+
+#include <cpu_simd.hpp>
+#include <trace.hpp>
+#include <util.hpp>
+
+// Neighbors of a cell, bits of a stencil.
+enum stencil_neighbor
+{
+    stencil_nw = 1 << 0,
+    stencil_n = 1 << 1,
+    stencil_ne = 1 << 2,
+    stencil_w = 1 << 3,
+    stencil_e = 1 << 4,
+    stencil_sw = 1 << 5,
+    stencil_s = 1 << 6,
+    stencil_se = 1 << 7
+};
+
+// Position of a vector of 16 cells in its row, which decides how the
+// neighbors of the cells at its ends wrap around.
+enum stencil_vec_pos { stencil_vec_middle, stencil_vec_first, stencil_vec_last, stencil_vec_whole };
+
+// Stencils with a name, any other mask of neighbors is a custom stencil.
+const int stencil_moore = 0xff;
+const int stencil_von_neumann = stencil_n | stencil_w | stencil_e | stencil_s;
+const int stencil_hex = stencil_moore & ~(stencil_ne | stencil_sw);
+
+/* Processes a row cell by cell, for rows narrower than a vector. */
+template <int S>
+static inline void cpu_stencil_seq_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+{
+    char* p_north = grid + (size_t)y_north * width;
+    char* p_row = grid + (size_t)y * width;
+    char* p_south = grid + (size_t)y_south * width;
+    char* p_buf = buf + (size_t)y * width;
+
+    for (int x = 0; x < width; x++) {
+        int x_west = x ? x - 1 : width - 1;
+        int x_east = x < width - 1 ? x + 1 : 0;
+        char count = 0;
+        if (S & stencil_nw) count += p_north[x_west];
+        if (S & stencil_n) count += p_north[x];
+        if (S & stencil_ne) count += p_north[x_east];
+        if (S & stencil_w) count += p_row[x_west];
+        if (S & stencil_e) count += p_row[x_east];
+        if (S & stencil_sw) count += p_south[x_west];
+        if (S & stencil_s) count += p_south[x];
+        if (S & stencil_se) count += p_south[x_east];
+        p_buf[x] = (count == 3) | ((count == 2) & p_row[x]);
+    }
+}
+
+#if defined __SSE2__ && defined __SSSE3__
+/* Loads the 16 cells of a row starting at x moved DX cells, so that every cell
+of the vector is the neighbor DX cells east of it. Vectors at the ends of the
+row wrap around to the other end like the row kernels of cpu_simd.hpp. */
+template <stencil_vec_pos P, int DX>
+static inline __m128i cpu_stencil_16_load(char* p, int width, int x)
+{
+    if (P == stencil_vec_whole) {
+        __m128i cells = _mm_load_si128((__m128i*)p);
+        return DX < 0 ? _mm_alignr_epi8(cells, cells, 15) : DX > 0 ? _mm_alignr_epi8(cells, cells, 1) : cells;
+    }
+    if (P == stencil_vec_first && DX < 0) {
+        return shift_in_first_16(_mm_loadu_si128((__m128i*)p), p[width - 1]);
+    }
+    if (P == stencil_vec_last && DX > 0) {
+        return shift_in_last_16(_mm_loadu_si128((__m128i*)(p + x)), *p);
+    }
+    return _mm_loadu_si128((__m128i*)(p + x + DX));
+}
+
+/* Calculates the next states of the 16 cells of a row starting at x. Only the
+neighbors in the stencil are loaded and added. */
+template <int S, stencil_vec_pos P>
+static inline __m128i cpu_stencil_16_vec(char* p_north, char* p_row, char* p_south, int width, int x)
+{
+    __m128i cells = cpu_stencil_16_load<P, 0>(p_row, width, x);
+    __m128i neighbors_count = _mm_setzero_si128();
+    if (S & stencil_nw) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, -1>(p_north, width, x));
+    }
+    if (S & stencil_n) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, 0>(p_north, width, x));
+    }
+    if (S & stencil_ne) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, 1>(p_north, width, x));
+    }
+    if (S & stencil_w) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, -1>(p_row, width, x));
+    }
+    if (S & stencil_e) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, 1>(p_row, width, x));
+    }
+    if (S & stencil_sw) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, -1>(p_south, width, x));
+    }
+    if (S & stencil_s) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, 0>(p_south, width, x));
+    }
+    if (S & stencil_se) {
+        neighbors_count = _mm_add_epi8(neighbors_count, cpu_stencil_16_load<P, 1>(p_south, width, x));
+    }
+    return cpu_simd_16_alive(cells, neighbors_count);
+}
+#endif
+
+/* Processes a row of any width, 16 cells at a time if it is at least 16
+wide. */
+template <int S>
+static inline void cpu_stencil_row(char* grid, char* buf, int width, int y, int y_north, int y_south)
+{
+#if defined __SSE2__ && defined __SSSE3__
+    if (width < 16) {
+        cpu_stencil_seq_row<S>(grid, buf, width, y, y_north, y_south);
+        return;
+    }
+    char* p_north = grid + (size_t)y_north * width;
+    char* p_row = grid + (size_t)y * width;
+    char* p_south = grid + (size_t)y_south * width;
+    char* p_buf = buf + (size_t)y * width;
+    if (width == 16) {
+        _mm_store_si128((__m128i*)p_buf, cpu_stencil_16_vec<S, stencil_vec_whole>(p_north, p_row, p_south, width, 0));
+        return;
+    }
+
+    // Like cpu_simd_16_row(), the last vector overlaps the one before it if
+    // the width is not a multiple of 16.
+    _mm_storeu_si128((__m128i*)p_buf, cpu_stencil_16_vec<S, stencil_vec_first>(p_north, p_row, p_south, width, 0));
+    for (int x = 16; x < width - 16; x += 16) {
+        _mm_storeu_si128((__m128i*)(p_buf + x),
+            cpu_stencil_16_vec<S, stencil_vec_middle>(p_north, p_row, p_south, width, x));
+    }
+    _mm_storeu_si128((__m128i*)(p_buf + width - 16),
+        cpu_stencil_16_vec<S, stencil_vec_last>(p_north, p_row, p_south, width, width - 16));
+#else
+    cpu_stencil_seq_row<S>(grid, buf, width, y, y_north, y_south);
+#endif
+}
+
+/* Simulates a world with stencil S cell by cell, the reference for the
+others. */
+template <int S>
+void cpu_stencil_seq(char* grid, int width, int height, int gens)
+{
+    size_t size = (size_t)width * height;
+    char* buf = new char[size];
+    for (int i = 0; i < gens; i++) {
+        for (int y = 0; y < height; y++) {
+            cpu_stencil_seq_row<S>(grid, buf, width, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+        }
+        swap_ptr((void**)&grid, (void**)&buf);
+    }
+
+    // If number of generations is odd, the result is in buf, so swap with grid.
+    if (gens % 2) {
+        swap_ptr((void**)&buf, (void**)&grid);
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
+/* Simulates a world with stencil S on threads threads with OpenMP, bands of
+rows like cpu_omp(). */
+template <int S>
+void cpu_omp_stencil(char* grid, int width, int height, int gens, int threads = omp_get_num_procs())
+{
+    size_t size = (size_t)width * height;
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+    char* buf = new char[size];
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(width, height, gens, rows_per_thread) firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+
+        for (int i = 0; i < gens; i++) {
+            GOL_TRACE_BEGIN("band", i);
+            for (int y = y_start; y < y_end; y++) {
+                cpu_stencil_row<S>(grid, buf, width, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+            }
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+            GOL_TRACE_BEGIN("barrier", i);
+            #pragma omp barrier
+            GOL_TRACE_END();
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * cpu_tiled.hpp
+ *
+ * Tile-major layout for worlds with width and height that are multiples of
+ * tile_dim. The world is split into tile_dim x tile_dim tiles, each stored
+ * contiguously with its rows in row-major order, and tiles are stored in
+ * row-major order of the tile grid. The north and south neighbors of a cell
+ * are then tile_dim bytes away instead of width, so a tile and its neighbors
+ * only span a few pages however wide the world is.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __CPU_TILED_HPP__
+#define __CPU_TILED_HPP__
+
+// Cells along each side of a tile. A row of a tile is one cache line.
+const int tile_dim = 64;
+const int tile_size = tile_dim * tile_dim;
+
+// Order of the tiles passed to tile_next().
+enum tile_neighbor { tile_nw, tile_n, tile_ne, tile_w, tile_c, tile_e, tile_sw, tile_s, tile_se };
+
+/* Copies a row-major world to tile-major order. */
+void tiled_from_rows(const char* grid, char* tiles, int width, int height);
+
+/* Copies a tile-major world to row-major order. */
+void tiled_to_rows(const char* tiles, char* grid, int width, int height);
+
+/* Calculates the next generation of the center tile of tiles, which holds the
+center tile and its eight neighbors in tile_neighbor order, into out. */
+void tile_next(const char* const* tiles, char* out);
+
+/* Simulates a tile-major world with multiple threads. */
+void cpu_omp_tiles(char* tiles, int width, int height, int gens);
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * edit_queue.hpp
+ *
+ * Edits of cells made while a simulation runs. Any number of threads push
+ * edits without locks, onto a stack that the engine takes as a whole with
+ * one atomic exchange between generations. Every thread of the engine then
+ * applies the parts of the taken edits that fall in its own rows, right after
+ * computing them, so edits never stop the simulation.
+ *
+ * Edits taken at the end of a generation are applied to the cells of the
+ * generation after it, so they show up at most two generations after they
+ * are pushed.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __EDIT_QUEUE_HPP__
+#define __EDIT_QUEUE_HPP__
+
+#include <atomic>
+
+enum cell_edit_op { cell_edit_set, cell_edit_clear, cell_edit_toggle };
+
+/* Sets, clears or toggles the rectangle of cells at x, y of width x height.
+The parts of it outside the world are ignored. */
+struct cell_edit
+{
+    int x;
+    int y;
+    int width;
+    int height;
+    int op;
+};
+
+struct edit_node
+{
+    cell_edit edit;
+    edit_node* next;
+};
+
+/* Edits taken from a queue, in the order they were pushed. */
+class edit_batch
+{
+private:
+    edit_node* _first;
+
+public:
+    inline edit_batch() : _first(nullptr) {};
+    explicit edit_batch(edit_node* first) : _first(first) {};
+    edit_batch(edit_batch&& other) : _first(other._first) { other._first = nullptr; };
+    edit_batch& operator=(edit_batch&& other);
+    ~edit_batch();
+
+    edit_batch(const edit_batch&) = delete;
+    edit_batch& operator=(const edit_batch&) = delete;
+
+    bool empty() const { return !_first; };
+
+    /* Applies the parts of every edit in rows y_start to y_end to a world. */
+    void apply(char* grid, int width, int height, int y_start, int y_end) const;
+};
+
+class edit_queue
+{
+private:
+    // Newest edit first.
+    std::atomic<edit_node*> _head;
+
+public:
+    inline edit_queue() : _head(nullptr) {};
+
+    /* Frees the edits that were never taken. */
+    ~edit_queue();
+
+    edit_queue(const edit_queue&) = delete;
+    edit_queue& operator=(const edit_queue&) = delete;
+
+    /* Adds an edit, from any thread. */
+    void push(const cell_edit& edit);
+
+    /* Adds an edit of one cell. */
+    inline void set_cell(int x, int y, bool alive)
+    {
+        push(cell_edit{x, y, 1, 1, alive ? cell_edit_set : cell_edit_clear});
+    };
+
+    /* Takes every edit pushed so far, by one thread at a time. */
+    edit_batch take();
+};
+
+/* Multi-threaded CPU SIMD with OpenMP that applies the edits pushed to the
+queue while it runs. Edits still in the queue when it returns are left for
+the next call. */
+void cpu_omp_edit(char* grid, int width, int height, int gens, edit_queue& edits);
+
+#endif
@@ -10,6 +10,8 @@
 #ifndef __GAME_OF_LIFE_HPP__
 #define __GAME_OF_LIFE_HPP__
 
+#include <cstdint>
+
 typedef void (*cpu_sim_t)(char*, int, int, int);
 
 /* CPU sequential */
@@ -18,11 +20,67 @@ void cpu_seq(char* grid, int width, int height, int gens);
 /* Single-threaded CPU SIMD */ 
 void cpu_simd(char* grid, int width, int height, int gens);
 
+/* Single-threaded CPU SIMD, horizontal sums of every row reused for the rows 
+north and south of it */
+void cpu_simd_rowsum(char* grid, int width, int height, int gens);
+
+/* Multi-threaded CPU with a table lookup for every 2x2 block of cells, width 
+and height must be even */
+void cpu_lut(char* grid, int width, int height, int gens);
+
 /* Multi-threaded CPU SIMD with OpenMP */
 void cpu_omp(char* grid, int width, int height, int gens);
 
+/* Multi-threaded CPU SIMD with OpenMP, horizontal sums of every row reused for 
+the rows north and south of it */
+void cpu_omp_rowsum(char* grid, int width, int height, int gens);
+
+/* Multi-threaded CPU SIMD with OpenMP on a copy of the world in 64x64 tiles */
+void cpu_omp_tiled(char* grid, int width, int height, int gens);
+
+/* Multi-threaded CPU SIMD with OpenMP and a given number of threads */
+void cpu_omp_threads(char* grid, int width, int height, int gens, int threads);
+
+/* Multi-threaded CPU SIMD with OpenMP, boundary rows published to neighboring
+threads instead of a barrier between generations */
+void cpu_omp_overlap(char* grid, int width, int height, int gens, int threads);
+
+/* Multi-threaded CPU SIMD with OpenMP, every thread a generation of a group of 
+threads generations streamed through the world in a single pass, a window of
+rows behind the thread before it, for narrow and tall worlds */
+void cpu_omp_pipeline(char* grid, int width, int height, int gens, int threads);
+
+/* Multi-threaded CPU SIMD with a work-stealing tile scheduler */
+void cpu_steal(char* grid, int width, int height, int gens);
+
+/* Multi-threaded CPU SIMD with a work-stealing tile scheduler and a given 
+number of threads */
+void cpu_steal_threads(char* grid, int width, int height, int gens, int threads);
+
+/* CPU with OpenMP and every OpenCL device together, rows split between them 
+by measured throughput */
+void cpu_gpu_hybrid(char* grid, int width, int height, int gens);
+
+/* Engine and thread count picked for the world from a measured profile of the
+host, see sim_auto.hpp */
+void sim_auto(char* grid, int width, int height, int gens);
+
 /* GPU with OpenCL */
 void gpu_ocl(char* grid, int width, int height, int gens, double* compute_time = nullptr, 
     double* transfer_in_time = nullptr, double* transfer_out_time = nullptr);
 
+/* GPU with OpenCL, 32 cells per word on the device. Width must be a multiple 
+of 32. */
+void gpu_ocl_packed(char* grid, int width, int height, int gens, double* compute_time = nullptr, 
+    double* transfer_in_time = nullptr, double* transfer_out_time = nullptr);
+
+/* GPU with OpenCL on a world already packed 32 cells per word, see 
+bitpack.hpp. Width must be a multiple of 32. */
+void gpu_ocl_bits(uint32_t* bits, int width, int height, int gens, double* compute_time = nullptr, 
+    double* transfer_in_time = nullptr, double* transfer_out_time = nullptr);
+
+/* GPU with OpenCL, neighbors of every cell given by a stencil of 
+cpu_stencil.hpp. Width must be a power of 2 greater than 16. */
+void gpu_ocl_stencil(char* grid, int width, int height, int gens, int stencil, double* compute_time = nullptr);
+
 #endif
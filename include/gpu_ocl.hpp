@@ -6,11 +6,35 @@
  * Author: Carl Marquez
  * Created on: December 30, 2019
  */
+#ifndef __GPU_OCL_HPP__
+#define __GPU_OCL_HPP__
+
 #include <CL/cl.hpp>
 #include <errno.h>
 #include <fstream>
 #include <libgen.h>
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Returns the path of the cached program binary for the kernel source built
+with options on the device, in $XDG_CACHE_HOME/game_of_life or 
+~/.cache/game_of_life. The name is a hash of the device, its driver version, 
+the source and the options. */
+std::string gpu_ocl_cache_path(const cl::Device& device, const std::string& source, 
+    const std::string& options = "");
+
+/* Returns the directory that gpu_ocl_kernels.cl is loaded from, the directory
+of the executable unless it is changed before the first compiler is created,
+such as to the directory of a library that loads the engines. */
+std::string& gpu_ocl_source_dir();
+
+/* Reads the cached program binary at path, returns false if there is none. */
+bool gpu_ocl_cache_load(const std::string& path, std::string& binary);
+
+/* Writes the binary of a program built for one device to path. Failing to
+write it only means the program is compiled again next time. */
+void gpu_ocl_cache_store(const std::string& path, const cl::Program& program);
 
 class gpu_ocl_compiler 
 {
@@ -20,36 +44,92 @@ public:
     cl::Program program;
     cl::CommandQueue queue;
     cl::Program::Sources sources;
+    int compute_units;
+    int max_local_size;
+    cl_ulong max_alloc_size;
+
+    /* Compiles the kernels for the default device. */
+    inline gpu_ocl_compiler() : gpu_ocl_compiler(default_device()) {};
 
-    inline gpu_ocl_compiler() 
+    /* Compiles the kernels for the given device, with build options such as
+    -D definitions. */
+    inline gpu_ocl_compiler(const cl::Device& _device, const std::string& options = "") : device(_device)
     {
-        // Get default device
-        cl_int err;
-        device = cl::Device::getDefault(&err);
-        if (err) {
-            throw std::runtime_error("No default device found");
-        }
+        cl_int err = CL_SUCCESS;
+        compute_units = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+        max_local_size = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+        max_alloc_size = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
 
         // Create context
         context = cl::Context({device});
 
         // Load kernel source
-        char* program_name_copy = strdup(program_invocation_name);
-        char* program_dir = dirname(program_name_copy);
-        std::string source_path = std::string(program_dir) + "/gpu_ocl_kernels.cl";
-        free(program_name_copy);
+        std::string source_path = gpu_ocl_source_dir() + "/gpu_ocl_kernels.cl";
         std::ifstream source_file(source_path);
         std::string source_code(std::istreambuf_iterator<char>(source_file), (std::istreambuf_iterator<char>()));
 
+        // Programs built before for the same device, driver and source are
+        // loaded from the cache instead of compiled again. Binaries the driver
+        // rejects are compiled from source and cached again.
+        std::string cache_path = gpu_ocl_cache_path(device, source_code, options);
+        std::string binary;
+        bool cached = gpu_ocl_cache_load(cache_path, binary);
+        if (cached) {
+            std::vector<cl_int> binary_status;
+            program = cl::Program(context, {device}, cl::Program::Binaries({{binary.data(), binary.size()}}), 
+                &binary_status, &err);
+            cached = !err && !program.build({device}, options.c_str());
+        }
+
         // Compile kernels
-        sources = cl::Program::Sources({{source_code.c_str(), source_code.length()}});
-        program = cl::Program(context, sources);
-        if ((err = program.build({device}))) {
-            throw std::runtime_error("OpenCL build error " + std::to_string(err) + "\n" + 
-                program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) + "\n");
+        if (!cached) {
+            sources = cl::Program::Sources({{source_code.c_str(), source_code.length()}});
+            program = cl::Program(context, sources);
+            if ((err = program.build({device}, options.c_str()))) {
+                throw std::runtime_error("OpenCL build error " + std::to_string(err) + "\n" + 
+                    program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) + "\n");
+            }
+            gpu_ocl_cache_store(cache_path, program);
         }
 
-        // Command queue and kernels
+        // Command queue and kernels, profiled to trace the kernels if tracing
+        // is compiled in.
+#ifdef GOL_TRACE
+        queue = cl::CommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE);
+#else
         queue = cl::CommandQueue(context, device);
+#endif
     };
-};
\ No newline at end of file
+
+private:
+    static inline cl::Device default_device()
+    {
+        // Get default device
+        cl_int err = CL_SUCCESS;
+        cl::Device device = cl::Device::getDefault(&err);
+        if (err) {
+            throw std::runtime_error("No default device found");
+        }
+        return device;
+    };
+};
+
+/* Throws if a buffer of size bytes is larger than the device allows. */
+static inline void gpu_ocl_check_alloc(const gpu_ocl_compiler& ocl, size_t size)
+{
+    if (size > ocl.max_alloc_size) {
+        throw std::invalid_argument("world of " + std::to_string(size) + " bytes is larger than the " + 
+            std::to_string(ocl.max_alloc_size) + " byte limit of the OpenCL device");
+    }
+}
+
+/* Returns true if there is a kernel for worlds of the given width. */
+bool gpu_ocl_supports_width(int width);
+
+/* Enqueues gens generations on the compiler's queue without waiting for them.
+The result is in grid_d if gens is even, buf_d otherwise. If events is given,
+the event of every generation's kernel is appended to it. */
+void gpu_ocl_enqueue(gpu_ocl_compiler& ocl, cl::Buffer& grid_d, cl::Buffer& buf_d, int width, int height, 
+    int gens, std::vector<cl::Event>* events = nullptr);
+
+#endif
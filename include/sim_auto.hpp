@@ -0,0 +1,53 @@
+/**
+ * sim_auto.hpp
+ *
+ * Picks the engine and thread count for a world from a profile of how fast
+ * every engine is on this host. The profile is measured the first time it is
+ * needed, for every width class of the row kernels and world sizes from a few
+ * rows to more than the last level cache holds, and kept in the cache
+ * directory. It is measured again when the processor, the number of
+ * processors or the OpenCL device are not the ones it was measured on.
+ *
+ * Every engine is modelled as a fixed time per run, such as allocating and
+ * transferring the world, plus a time per generation. Both are scaled by the
+ * cells of the world over the cells of the nearest measured size, so the
+ * engine with a large fixed time wins only when the world is simulated for
+ * enough generations.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __SIM_AUTO_HPP__
+#define __SIM_AUTO_HPP__
+
+#include <string>
+
+enum sim_auto_engine { sim_auto_cpu_simd, sim_auto_cpu_simd_rowsum, sim_auto_cpu_omp, sim_auto_gpu_ocl };
+
+struct sim_auto_choice
+{
+    int engine;
+
+    // OpenMP threads of cpu_omp, 1 for the single-threaded engines and 0 for
+    // the GPU.
+    int threads;
+};
+
+/* Returns the engine that is expected to simulate the world fastest,
+measuring the profile first if there is none for this host. */
+sim_auto_choice sim_auto_choose(int width, int height, int gens);
+
+/* Returns the name of a sim_auto_engine. */
+const char* sim_auto_engine_name(int engine);
+
+/* Measures the profile of this host again and stores it, for when something
+the host identity does not cover, like a driver, has changed. Takes a few
+seconds. */
+void sim_auto_calibrate();
+
+/* Returns the path the profile is stored at, $GOL_AUTO_PROFILE or
+auto_profile.txt in the cache directory. Empty if there is neither, in which
+case the profile is measured once per process. */
+std::string sim_auto_profile_path();
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * sim_pool.hpp
+ *
+ * Runs many simulations at once on one persistent pool of threads. Every
+ * simulation is a job that is split into bands of rows every generation, and
+ * idle threads take the next band of the job that should run next, so the
+ * cores are divided between the active jobs instead of every job starting
+ * threads of its own.
+ *
+ * Jobs of a higher priority always go first. Among jobs of the same priority,
+ * the job that has been given the fewest cells so far goes next, so that jobs
+ * of different sizes get an equal share of the pool.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __SIM_POOL_HPP__
+#define __SIM_POOL_HPP__
+
+#include <condition_variable>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum sim_priority { sim_priority_low, sim_priority_normal, sim_priority_high };
+
+/* Times of a finished job in ms. */
+struct sim_job_stats
+{
+    // From submitting the job to a thread starting its first band.
+    double queue_time;
+
+    // From a thread starting its first band to the job finishing.
+    double compute_time;
+};
+
+class sim_pool
+{
+private:
+    struct job;
+
+    std::mutex _mutex;
+    std::condition_variable _work;
+    std::list<std::unique_ptr<job>> _jobs;
+    std::vector<std::thread> _threads;
+    bool _stop;
+
+    void run();
+    job* next_job();
+
+public:
+    /* Starts threads threads, one per processor by default. */
+    explicit sim_pool(int threads = 0);
+
+    /* Finishes every submitted job before returning. */
+    ~sim_pool();
+
+    /* Simulates grid for gens generations with the given sim_priority. grid
+    must stay valid until the future is ready, which is when the result is in
+    grid. */
+    std::future<sim_job_stats> submit(char* grid, int width, int height, int gens,
+        int priority = sim_priority_normal);
+
+    int threads() const { return _threads.size(); };
+};
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * soup_search.hpp
+ *
+ * Searches random 16x16 soups and counts the objects they settle into, in the
+ * manner of apgsearch. Every soup is simulated on a 256x256 bitboard, with the
+ * soup in the middle and dead cells beyond the edges, until the whole board
+ * repeats with a period of up to soup_max_period. Objects that reach the edge
+ * are classified and removed if they are spaceships like gliders, otherwise
+ * the soup is given up on.
+ *
+ * Objects are the connected cells of the board over every phase of its
+ * period, each simulated on its own to find its period and its motion. They
+ * are named like apgcodes, xs<population> for still lifes, xp<period> for
+ * oscillators and xq<period> for spaceships, followed by the common name of
+ * the object or a hash of its canonical form, the smallest encoding of its
+ * cells over every rotation, reflection and phase.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __SOUP_SEARCH_HPP__
+#define __SOUP_SEARCH_HPP__
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Size of the soups, and of the board they are simulated on.
+const int soup_size = 16;
+const int soup_board_size = 256;
+
+// Longest period of a settled board, and most generations before a soup is
+// given up on.
+const int soup_max_period = 30;
+const int soup_max_gens = 10000;
+
+struct soup_census
+{
+    uint64_t soups;
+
+    // Soups that did not settle in soup_max_gens generations, or grew past
+    // the edges of the board.
+    uint64_t unsettled;
+
+    // Objects by name.
+    std::map<std::string, uint64_t> objects;
+
+    double seconds;
+
+    inline double soups_per_second() const { return soups / seconds; };
+};
+
+/* Searches soups start to start + soups - 1 of a seed on threads threads, one
+per processor by default. The same seed and soups always give the same
+census. */
+soup_census soup_search(uint64_t seed, uint64_t start, uint64_t soups, int threads = 0);
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * trace.hpp
+ *
+ * Timeline of what every thread and OpenCL device does each generation,
+ * written as a Chrome trace that chrome://tracing and Perfetto open. Only
+ * compiled in when GOL_TRACE is defined, e.g. with cmake -DGOL_TRACE=ON,
+ * otherwise the macros below expand to nothing.
+ *
+ * Every thread records into a buffer of its own, so recording never takes a
+ * lock. Events past the capacity of a buffer are dropped and counted.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#ifdef GOL_TRACE
+
+#include <cstdint>
+#include <string>
+
+/* Returns the time in ns on the clock every event is recorded with. */
+uint64_t trace_now();
+
+/* Returns the track with the given name, created on first use. Threads get a
+track of their own when they first record. */
+int trace_track(const std::string& name);
+
+/* Records an event from begin to end on a track. gen is shown with the event,
+-1 if it belongs to no generation. */
+void trace_record(int track, const char* name, int gen, uint64_t begin, uint64_t end);
+
+/* Starts an event on the track of the calling thread, ended by the next
+trace_end() of the thread. Events may be nested. name must outlive the
+trace. */
+void trace_begin(const char* name, int gen);
+
+/* Ends the event last started by the calling thread. */
+void trace_end();
+
+/* Writes every event recorded so far as Chrome trace JSON to path, by default
+$GOL_TRACE_FILE or game_of_life_trace.json. Must not be called while threads
+are recording. */
+void trace_write(const char* path = nullptr);
+
+#define GOL_TRACE_BEGIN(name, gen) trace_begin(name, gen)
+#define GOL_TRACE_END() trace_end()
+#define GOL_TRACE_WRITE() trace_write()
+
+#else
+
+#define GOL_TRACE_BEGIN(name, gen) ((void)sizeof(gen))
+#define GOL_TRACE_END() ((void)0)
+#define GOL_TRACE_WRITE() ((void)0)
+
+#endif
+
+#endif
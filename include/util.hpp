@@ -11,6 +11,16 @@
 
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+
+// L1 data cache line size of the host, defined in cpu_omp.cpp.
+extern const int cache_line_size;
+
+/* Splits height rows into bands of *rows_per_thread rows for up to threads 
+threads, and returns the number of bands. Defined in cpu_omp.cpp. */
+int cpu_omp_bands(int width, int height, int threads, int* rows_per_thread);
 
 class my_timer
 {
@@ -63,4 +73,27 @@ static inline void swap_ptr(void** a, void** b)
     *b = temp;
 }
 
+/* Returns the directory that files kept between runs are cached in, 
+$XDG_CACHE_HOME/game_of_life or ~/.cache/game_of_life, empty if neither is set.
+The directory is created if it does not exist. */
+static inline std::string cache_dir()
+{
+    const char* cache_home = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    std::string dir;
+    if (cache_home && *cache_home) {
+        dir = cache_home;
+    }
+    else if (home && *home) {
+        dir = std::string(home) + "/.cache";
+    }
+    else {
+        return "";
+    }
+    mkdir(dir.c_str(), 0755);
+    dir += "/game_of_life";
+    mkdir(dir.c_str(), 0755);
+    return dir;
+}
+
 #endif
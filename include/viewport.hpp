@@ -0,0 +1,132 @@
+/**
+ * viewport.hpp
+ *
+ * Zoomed out views of a rectangle of the world, produced by the engines while
+ * they simulate instead of from a copy of the whole world afterwards. Every
+ * scale x scale block of cells of the rectangle is one pixel, either the
+ * share of alive cells in the block from 0 to 255 or 255 if any cell in it is
+ * alive.
+ *
+ * Frames go into a ring of slots in POSIX shared memory that other processes
+ * on the host map and read in place. Every slot has a sequence number that is
+ * odd while the slot is written, so a reader checks it before and after
+ * reading a frame to know the frame was not overwritten meanwhile. The writer
+ * never waits for readers.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifndef __VIEWPORT_HPP__
+#define __VIEWPORT_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum viewport_mode { viewport_density, viewport_max };
+
+/* Rectangle of the world at x, y of width x height cells, drawn one pixel per
+scale x scale cells. Width and height must be multiples of scale. */
+struct viewport
+{
+    int x;
+    int y;
+    int width;
+    int height;
+    int scale;
+    int mode;
+
+    inline int frame_width() const { return width / scale; };
+    inline int frame_height() const { return height / scale; };
+};
+
+/* Throws if the viewport does not fit in a world of the given size. */
+void viewport_check(const viewport& view, int world_width, int world_height);
+
+/* Adds the alive cells of a row of the viewport to the cell counts of a row of
+pixels. */
+void viewport_add_row(const viewport& view, const char* row, uint32_t* counts);
+
+/* Converts the cell counts of every pixel to the pixels of a frame. */
+void viewport_draw(const viewport& view, const uint32_t* counts, uint8_t* pixels);
+
+/* Frame as a reader sees it. pixels point into the shared memory of the ring,
+so they are only valid as long as viewport_ring::valid() returns true. */
+struct viewport_frame
+{
+    const uint8_t* pixels;
+    int width;
+    int height;
+    int64_t gen;
+    uint64_t seq;
+    int slot;
+};
+
+class viewport_ring
+{
+private:
+    struct header;
+    struct slot_header;
+
+    std::string _name;
+    bool _owner;
+    void* _memory;
+    size_t _size;
+    header* _header;
+
+    slot_header* slot(int i) const;
+
+public:
+    /* Creates the shared memory object /name for frames of frame_width x
+    frame_height pixels in slots slots, replacing any by the same name. It is
+    removed again when the ring is destroyed, readers that have mapped it
+    keep it until they unmap it. */
+    viewport_ring(const std::string& name, int frame_width, int frame_height, int slots = 4);
+
+    /* Maps the ring created as /name by another process, read-only. */
+    explicit viewport_ring(const std::string& name);
+
+    ~viewport_ring();
+
+    viewport_ring(const viewport_ring&) = delete;
+    viewport_ring& operator=(const viewport_ring&) = delete;
+
+    int frame_width() const;
+    int frame_height() const;
+
+    /* Returns the pixels of the next slot for the writer to draw a frame into.
+    The slot is not read until publish(). */
+    uint8_t* begin_frame();
+
+    /* Makes the frame drawn since begin_frame() the latest, as the frame of
+    generation gen. */
+    void publish(int64_t gen);
+
+    /* Gets the latest frame, returns false if no frame has been published or
+    the writer never finished drawing it. */
+    bool latest(viewport_frame& frame) const;
+
+    /* Gets frame n of the ring, the first frame published being frame 0,
+    returns false if it has not been published yet or a later frame has 
+    overwritten it. */
+    bool frame(uint64_t n, viewport_frame& frame) const;
+
+    /* Returns true if the frame has not been overwritten since latest() or frame() got it,
+    to be checked after its pixels have been read. */
+    bool valid(const viewport_frame& frame) const;
+};
+
+/* Multi-threaded CPU SIMD with OpenMP that also draws the viewport into the
+ring after every period generations, from every row of the viewport as it is
+written. */
+void cpu_omp_view(char* grid, int width, int height, int gens, const viewport& view, viewport_ring& ring,
+    int period = 1);
+
+/* GPU with OpenCL that also draws the viewport into the ring after every
+period generations. Pixels are reduced on the device so only the frame is
+transferred. */
+void gpu_ocl_view(char* grid, int width, int height, int gens, const viewport& view, viewport_ring& ring,
+    int period = 1);
+
+#endif
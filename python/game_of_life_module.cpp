@@ -0,0 +1,180 @@
+/**
+ * game_of_life_module.cpp
+ *
+ * Python module of the engines. Every function simulates a world in place
+ * without copying it, given as a writable C-contiguous 2D buffer of uint8
+ * cells, such as a NumPy array of dtype uint8 with a row per element of its
+ * first axis:
+ *
+ *     import numpy, game_of_life
+ *     world = (numpy.random.rand(1024, 1024) < 0.5).astype(numpy.uint8)
+ *     game_of_life.cpu_omp(world, 100)
+ *
+ * Cells must be 0 or 1. The GIL is released while a world is simulated, so
+ * other Python threads run meanwhile, but must not use the world until the
+ * function returns.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <dlfcn.h>
+#include <libgen.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <game_of_life.hpp>
+#include <gpu_ocl.hpp>
+
+// Rows of 16 cells are loaded aligned by the SIMD kernels, and every cell
+// must have 8 neighbors.
+const size_t world_alignment = 16;
+const int min_dim = 3;
+
+/* Runs gpu_ocl without its timings. */
+static void gpu_ocl_world(char* grid, int width, int height, int gens)
+{
+    gpu_ocl(grid, width, height, gens);
+}
+
+/* Returns why the buffer of a world cannot be simulated by the engine, empty
+if it can. */
+static std::string world_check(const Py_buffer& view, bool gpu)
+{
+    // Formats may start with a byte order, which does not matter for bytes.
+    const char* format = view.format ? view.format : "B";
+    if (strchr("@=<>!", *format)) {
+        format++;
+    }
+    if (strcmp(format, "B")) {
+        return "world must be of uint8 cells, not '" + std::string(view.format) + "'";
+    }
+    if (view.ndim != 2) {
+        return "world must have 2 dimensions, not " + std::to_string(view.ndim);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (view.shape[i] < min_dim || view.shape[i] > INT_MAX) {
+            return "world dimensions must be between " + std::to_string(min_dim) + " and " +
+                std::to_string(INT_MAX);
+        }
+    }
+    if ((uintptr_t)view.buf % world_alignment) {
+        return "world must be aligned to " + std::to_string(world_alignment) + " bytes";
+    }
+    if (gpu && !gpu_ocl_supports_width(view.shape[1])) {
+        return "no OpenCL kernel for worlds " + std::to_string(view.shape[1]) + " wide";
+    }
+    return "";
+}
+
+/* Simulates the world and number of generations of args in place with sim,
+without the GIL. */
+static PyObject* simulate(PyObject* args, cpu_sim_t sim, bool gpu)
+{
+    PyObject* world;
+    int gens;
+    if (!PyArg_ParseTuple(args, "Oi", &world, &gens)) {
+        return nullptr;
+    }
+    if (gens < 0) {
+        PyErr_SetString(PyExc_ValueError, "gens must not be negative");
+        return nullptr;
+    }
+    Py_buffer view;
+    if (PyObject_GetBuffer(world, &view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS)) {
+        return nullptr;
+    }
+    std::string message = world_check(view, gpu);
+    if (!message.empty()) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_ValueError, message.c_str());
+        return nullptr;
+    }
+
+    // Exceptions are turned into Python errors once the GIL is held again.
+    PyObject* error = nullptr;
+    char* grid = (char*)view.buf;
+    int width = view.shape[1];
+    int height = view.shape[0];
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        sim(grid, width, height, gens);
+    }
+    catch (const std::invalid_argument& e) {
+        error = PyExc_ValueError;
+        message = e.what();
+    }
+    catch (const std::bad_alloc& e) {
+        error = PyExc_MemoryError;
+        message = e.what();
+    }
+    catch (const std::exception& e) {
+        error = PyExc_RuntimeError;
+        message = e.what();
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    if (error) {
+        PyErr_SetString(error, message.c_str());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_cpu_seq(PyObject*, PyObject* args)
+{
+    return simulate(args, cpu_seq, false);
+}
+
+static PyObject* py_cpu_simd(PyObject*, PyObject* args)
+{
+    return simulate(args, cpu_simd, false);
+}
+
+static PyObject* py_cpu_omp(PyObject*, PyObject* args)
+{
+    return simulate(args, cpu_omp, false);
+}
+
+static PyObject* py_gpu_ocl(PyObject*, PyObject* args)
+{
+    return simulate(args, gpu_ocl_world, true);
+}
+
+static PyMethodDef methods[] = {
+    {"cpu_seq", py_cpu_seq, METH_VARARGS,
+        "cpu_seq(world, gens)\n\nSimulates world gens generations in place, sequentially."},
+    {"cpu_simd", py_cpu_simd, METH_VARARGS,
+        "cpu_simd(world, gens)\n\nSimulates world gens generations in place, single-threaded SIMD."},
+    {"cpu_omp", py_cpu_omp, METH_VARARGS,
+        "cpu_omp(world, gens)\n\nSimulates world gens generations in place, multi-threaded SIMD."},
+    {"gpu_ocl", py_gpu_ocl, METH_VARARGS,
+        "gpu_ocl(world, gens)\n\nSimulates world gens generations in place on the default OpenCL device. The\n"
+        "width must be 4, 8, 16 or a power of 2 greater than 16."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "game_of_life",
+    "Conway's Game of Life engines on writable C-contiguous 2D buffers of uint8 cells, such as NumPy arrays.",
+    -1, methods, nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit_game_of_life()
+{
+    // The kernels are next to the module, not the Python executable.
+    Dl_info info;
+    if (dladdr((void*)PyInit_game_of_life, &info) && info.dli_fname) {
+        char* module_path = strdup(info.dli_fname);
+        gpu_ocl_source_dir() = dirname(module_path);
+        free(module_path);
+    }
+    return PyModule_Create(&module);
+}
@@ -0,0 +1,33 @@
+/**
+ * change_stream.cpp
+ *
+ * Stream of the cells that changed in every generation, see change_stream.hpp.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <change_stream.hpp>
+
+uint64_t* change_stream::append(size_t count)
+{
+    size_t start = _entries.size();
+    _entries.resize(start + count);
+    _ends.push_back(start + count);
+    return _entries.data() + start;
+}
+
+void change_stream::clear()
+{
+    _entries.clear();
+    _ends.clear();
+}
+
+void change_stream::apply(char* grid, size_t gen) const
+{
+    for (const uint64_t* entry = begin(gen); entry != end(gen); entry++) {
+        char* cells = grid + change_entry_cell(*entry);
+        for (unsigned bits = change_entry_bits(*entry); bits; bits &= bits - 1) {
+            cells[__builtin_ctz(bits)] ^= 1;
+        }
+    }
+}
@@ -0,0 +1,270 @@
+/**
+ * cow_world.cpp
+ *
+ * Copy-on-write tiled worlds, see cow_world.hpp.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <cow_world.hpp>
+
+cow_tile::cow_tile() : cells((char*)aligned_alloc(tile_dim, tile_size))
+{
+    if (!cells) {
+        throw std::bad_alloc();
+    }
+}
+
+cow_tile::~cow_tile()
+{
+    free(cells);
+}
+
+/* Returns the tile shared by every tile with no alive cells. */
+static const std::shared_ptr<cow_tile>& empty_tile()
+{
+    static const std::shared_ptr<cow_tile> empty = [] {
+        std::shared_ptr<cow_tile> tile(new cow_tile);
+        memset(tile->cells, 0, tile_size);
+        return tile;
+    }();
+    return empty;
+}
+
+static bool tile_is_empty(const char* cells)
+{
+    const uint64_t* words = (const uint64_t*)cells;
+    uint64_t any = 0;
+    for (int i = 0; i < tile_size / 8; i++) {
+        any |= words[i];
+    }
+    return !any;
+}
+
+/* Returns a hash of the cells of a tile, in 4 independent lanes. */
+static uint64_t tile_hash(const char* cells)
+{
+    const uint64_t* words = (const uint64_t*)cells;
+    uint64_t lanes[4] = {1, 2, 3, 4};
+    for (int i = 0; i < tile_size / 8; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            lanes[lane] = (lanes[lane] ^ words[i + lane]) * 0x100000001b3ULL;
+        }
+    }
+    return lanes[0] ^ (lanes[1] << 1) ^ (lanes[2] << 2) ^ (lanes[3] << 3);
+}
+
+cow_world::cow_world(const char* grid, int width, int height) : _width(width), _height(height)
+{
+    if (width < tile_dim || height < tile_dim || width % tile_dim || height % tile_dim) {
+        throw std::invalid_argument("width and height of a copy-on-write world must be multiples of " +
+            std::to_string(tile_dim));
+    }
+    _tiles_x = width / tile_dim;
+    _tiles_y = height / tile_dim;
+    _tiles.resize((size_t)_tiles_x * _tiles_y);
+
+    std::shared_ptr<cow_tile> tile(new cow_tile);
+    for (size_t t = 0; t < _tiles.size(); t++) {
+        const char* corner = grid + (t / _tiles_x) * tile_dim * (size_t)width + (t % _tiles_x) * tile_dim;
+        for (int y = 0; y < tile_dim; y++) {
+            memcpy(tile->cells + y * tile_dim, corner + (size_t)y * width, tile_dim);
+        }
+        // Empty tiles reuse the same buffer for the next tile.
+        if (tile_is_empty(tile->cells)) {
+            _tiles[t] = empty_tile();
+        }
+        else {
+            _tiles[t] = tile;
+            tile.reset(new cow_tile);
+        }
+    }
+}
+
+cow_tile* cow_world::writable_tile(int t)
+{
+    if (_tiles[t].use_count() > 1) {
+        std::shared_ptr<cow_tile> copy(new cow_tile);
+        memcpy(copy->cells, _tiles[t]->cells, tile_size);
+        _tiles[t] = copy;
+    }
+    return _tiles[t].get();
+}
+
+bool cow_world::cell(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        throw std::out_of_range("cell is outside the world");
+    }
+    const cow_tile* tile = _tiles[(y / tile_dim) * _tiles_x + x / tile_dim].get();
+    return tile->cells[(y % tile_dim) * tile_dim + x % tile_dim];
+}
+
+void cow_world::set_cell(int x, int y, bool alive)
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        throw std::out_of_range("cell is outside the world");
+    }
+    int t = (y / tile_dim) * _tiles_x + x / tile_dim;
+    int i = (y % tile_dim) * tile_dim + x % tile_dim;
+    if (_tiles[t]->cells[i] != alive) {
+        writable_tile(t)->cells[i] = alive;
+    }
+}
+
+void cow_world::to_rows(char* grid) const
+{
+    for (size_t t = 0; t < _tiles.size(); t++) {
+        char* corner = grid + (t / _tiles_x) * tile_dim * (size_t)_width + (t % _tiles_x) * tile_dim;
+        for (int y = 0; y < tile_dim; y++) {
+            memcpy(corner + (size_t)y * _width, _tiles[t]->cells + y * tile_dim, tile_dim);
+        }
+    }
+}
+
+void cow_world::step(int gens)
+{
+    step(std::vector<cow_world*>(1, this), gens);
+}
+
+/* Tile and its eight neighbors in tile_neighbor order. */
+struct cow_neighborhood
+{
+    const cow_tile* tiles[9];
+
+    inline bool operator==(const cow_neighborhood& other) const
+    {
+        return !memcmp(tiles, other.tiles, sizeof(tiles));
+    };
+};
+
+struct cow_neighborhood_hash
+{
+    inline size_t operator()(const cow_neighborhood& neighborhood) const
+    {
+        size_t hash = 0;
+        for (int i = 0; i < 9; i++) {
+            hash = hash * 0x9e3779b97f4a7c15ULL + std::hash<const cow_tile*>()(neighborhood.tiles[i]);
+        }
+        return hash;
+    };
+};
+
+void cow_world::step(const std::vector<cow_world*>& worlds, int gens)
+{
+    const cow_tile* empty = empty_tile().get();
+    for (int i = 0; i < gens; i++) {
+        // Every distinct neighborhood of a tile with alive cells around it is
+        // computed once. Tiles of this generation are all held by the worlds
+        // until the next generation replaces them, so tile addresses identify
+        // them.
+        std::unordered_map<cow_neighborhood, size_t, cow_neighborhood_hash> job_of;
+        std::vector<cow_neighborhood> jobs;
+        std::vector<std::vector<size_t>> world_jobs(worlds.size());
+        for (size_t w = 0; w < worlds.size(); w++) {
+            const cow_world& world = *worlds[w];
+            world_jobs[w].resize(world._tiles.size());
+            for (size_t t = 0; t < world._tiles.size(); t++) {
+                int tx = t % world._tiles_x;
+                int ty = t / world._tiles_x;
+                int tx_west = tx ? tx - 1 : world._tiles_x - 1;
+                int tx_east = tx < world._tiles_x - 1 ? tx + 1 : 0;
+                int ty_north = ty ? ty - 1 : world._tiles_y - 1;
+                int ty_south = ty < world._tiles_y - 1 ? ty + 1 : 0;
+                const int neighbors[9] = {
+                    ty_north * world._tiles_x + tx_west,
+                    ty_north * world._tiles_x + tx,
+                    ty_north * world._tiles_x + tx_east,
+                    ty * world._tiles_x + tx_west,
+                    ty * world._tiles_x + tx,
+                    ty * world._tiles_x + tx_east,
+                    ty_south * world._tiles_x + tx_west,
+                    ty_south * world._tiles_x + tx,
+                    ty_south * world._tiles_x + tx_east
+                };
+                cow_neighborhood neighborhood;
+                bool any = false;
+                for (int n = 0; n < 9; n++) {
+                    neighborhood.tiles[n] = world._tiles[neighbors[n]].get();
+                    any |= neighborhood.tiles[n] != empty;
+                }
+                if (!any) {
+                    world_jobs[w][t] = SIZE_MAX;
+                    continue;
+                }
+                auto inserted = job_of.insert(std::make_pair(neighborhood, jobs.size()));
+                if (inserted.second) {
+                    jobs.push_back(neighborhood);
+                }
+                world_jobs[w][t] = inserted.first->second;
+            }
+        }
+
+        std::vector<std::shared_ptr<cow_tile>> results(jobs.size());
+        std::vector<uint64_t> hashes(jobs.size());
+        int64_t jobs_count = jobs.size();
+        #pragma omp parallel for schedule(dynamic) default(none) shared(jobs, results, hashes, jobs_count)
+        for (int64_t j = 0; j < jobs_count; j++) {
+            const char* cells[9];
+            for (int n = 0; n < 9; n++) {
+                cells[n] = jobs[j].tiles[n]->cells;
+            }
+            std::shared_ptr<cow_tile> tile(new cow_tile);
+            tile_next(cells, tile->cells);
+            if (tile_is_empty(tile->cells)) {
+                results[j] = empty_tile();
+            }
+            else {
+                results[j] = tile;
+                hashes[j] = tile_hash(tile->cells);
+            }
+        }
+
+        // A tile next to a tile that differs between worlds has a different
+        // neighborhood in each, but mostly the same cells once computed, as
+        // differences spread a cell per generation. Tiles with the same cells
+        // are shared again, so worlds only differ where their cells do.
+        std::unordered_map<uint64_t, size_t> first_of;
+        for (size_t j = 0; j < results.size(); j++) {
+            if (results[j] == empty_tile()) {
+                continue;
+            }
+            auto inserted = first_of.insert(std::make_pair(hashes[j], j));
+            size_t first = inserted.first->second;
+            if (!inserted.second && !memcmp(results[first]->cells, results[j]->cells, tile_size)) {
+                results[j] = results[first];
+            }
+        }
+
+        for (size_t w = 0; w < worlds.size(); w++) {
+            std::vector<std::shared_ptr<cow_tile>>& tiles = worlds[w]->_tiles;
+            for (size_t t = 0; t < tiles.size(); t++) {
+                size_t job = world_jobs[w][t];
+                tiles[t] = job == SIZE_MAX ? empty_tile() : results[job];
+            }
+        }
+    }
+}
+
+size_t cow_world::distinct_tiles(const std::vector<const cow_world*>& worlds)
+{
+    std::unordered_set<const cow_tile*> tiles;
+    for (const cow_world* world : worlds) {
+        for (const std::shared_ptr<cow_tile>& tile : world->_tiles) {
+            if (tile != empty_tile()) {
+                tiles.insert(tile.get());
+            }
+        }
+    }
+    return tiles.size();
+}
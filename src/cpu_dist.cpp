@@ -0,0 +1,317 @@
+/**
+ * cpu_dist.cpp
+ *
+ * Distributed-memory Game of Life. Every process owns a band of rows padded
+ * with halo ghost rows on each side. After a ghost row exchange, a process can
+ * advance halo generations without communicating, because the invalid region
+ * that grows from the edges of the padded band by one row per generation
+ * never reaches the band itself.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Only the C API of MPI is used, the C++ bindings of some implementations do
+// not compile without warnings.
+#ifdef GOL_HAVE_MPI
+#define OMPI_SKIP_MPICXX 1
+#define MPICH_SKIP_MPICXX 1
+#include <mpi.h>
+#endif
+
+#include <cpu_dist.hpp>
+#include <cpu_simd.hpp>
+#include <util.hpp>
+
+/* Sends as much as the socket accepts without blocking, returns bytes sent. */
+static int socket_send(int fd, const char* data, int bytes)
+{
+    ssize_t n = send(fd, data, bytes, MSG_NOSIGNAL);
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        throw std::runtime_error("send failed: " + std::string(strerror(errno)));
+    }
+    return n > 0 ? n : 0;
+}
+
+/* Receives what is available without blocking, returns bytes received. */
+static int socket_recv(int fd, char* data, int bytes)
+{
+    ssize_t n = recv(fd, data, bytes, 0);
+    if (!n) {
+        throw std::runtime_error("neighbor disconnected");
+    }
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        throw std::runtime_error("recv failed: " + std::string(strerror(errno)));
+    }
+    return n > 0 ? n : 0;
+}
+
+dist_transport_socket::dist_transport_socket(int rank, int size, int fd_north, int fd_south)
+    : _rank(rank), _size(size), _fd_north(fd_north), _fd_south(fd_south)
+{
+    if (size > 1) {
+        fcntl(_fd_north, F_SETFL, fcntl(_fd_north, F_GETFL) | O_NONBLOCK);
+        fcntl(_fd_south, F_SETFL, fcntl(_fd_south, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+dist_transport_socket::~dist_transport_socket()
+{
+    if (_size > 1) {
+        close(_fd_north);
+        close(_fd_south);
+    }
+}
+
+void dist_transport_socket::exchange(const char* north_out, const char* south_out, char* north_in,
+    char* south_in, int bytes)
+{
+    // A single process is its own north and south neighbor.
+    if (_size == 1) {
+        memcpy(north_in, south_out, bytes);
+        memcpy(south_in, north_out, bytes);
+        return;
+    }
+
+    // All four transfers progress together, otherwise two neighbors that both
+    // send first would deadlock once the socket buffers are full.
+    int north_sent = 0;
+    int south_sent = 0;
+    int north_recvd = 0;
+    int south_recvd = 0;
+    while (north_sent < bytes || south_sent < bytes || north_recvd < bytes || south_recvd < bytes) {
+        struct pollfd fds[2];
+        fds[0].fd = _fd_north;
+        fds[0].events = (north_sent < bytes ? POLLOUT : 0) | (north_recvd < bytes ? POLLIN : 0);
+        fds[1].fd = _fd_south;
+        fds[1].events = (south_sent < bytes ? POLLOUT : 0) | (south_recvd < bytes ? POLLIN : 0);
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("poll failed: " + std::string(strerror(errno)));
+        }
+        if ((fds[0].revents | fds[1].revents) & (POLLERR | POLLNVAL)) {
+            throw std::runtime_error("neighbor disconnected");
+        }
+
+        if (fds[0].revents & POLLOUT) {
+            north_sent += socket_send(_fd_north, north_out + north_sent, bytes - north_sent);
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP) && north_recvd < bytes) {
+            north_recvd += socket_recv(_fd_north, north_in + north_recvd, bytes - north_recvd);
+        }
+        if (fds[1].revents & POLLOUT) {
+            south_sent += socket_send(_fd_south, south_out + south_sent, bytes - south_sent);
+        }
+        if (fds[1].revents & (POLLIN | POLLHUP) && south_recvd < bytes) {
+            south_recvd += socket_recv(_fd_south, south_in + south_recvd, bytes - south_recvd);
+        }
+    }
+}
+
+#ifdef GOL_HAVE_MPI
+/* Finalizes MPI at process exit, so every dist_transport_mpi in the process shares
+one initialization. */
+static void dist_mpi_finalize()
+{
+    int finalized;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+        MPI_Finalize();
+    }
+}
+
+dist_transport_mpi::dist_transport_mpi()
+{
+    int initialized;
+    MPI_Initialized(&initialized);
+    if (!initialized) {
+        MPI_Init(nullptr, nullptr);
+        atexit(dist_mpi_finalize);
+    }
+    MPI_Comm_rank(MPI_COMM_WORLD, &_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &_size);
+}
+
+void dist_transport_mpi::exchange(const char* north_out, const char* south_out, char* north_in,
+    char* south_in, int bytes)
+{
+    int north = (_rank + _size - 1) % _size;
+    int south = (_rank + 1) % _size;
+    MPI_Sendrecv(north_out, bytes, MPI_CHAR, north, 0, south_in, bytes, MPI_CHAR, south, 0, MPI_COMM_WORLD,
+        MPI_STATUS_IGNORE);
+    MPI_Sendrecv(south_out, bytes, MPI_CHAR, south, 1, north_in, bytes, MPI_CHAR, north, 1, MPI_COMM_WORLD,
+        MPI_STATUS_IGNORE);
+}
+#endif
+
+void dist_band(int height, int size, int rank, int* y_start, int* rows)
+{
+    // Same split as the OpenMP bands, except the remainder is spread over the
+    // first ranks so that no band is much shorter than the others.
+    int base = height / size;
+    int extra = height % size;
+    *y_start = rank * base + (rank < extra ? rank : extra);
+    *rows = base + (rank < extra ? 1 : 0);
+}
+
+void dist_spawn_local(int procs, const std::function<void(dist_transport&)>& func)
+{
+    if (procs < 1) {
+        throw std::invalid_argument("procs must be at least 1");
+    }
+    if (procs == 1) {
+        dist_transport_socket transport(0, 1, -1, -1);
+        func(transport);
+        return;
+    }
+
+    // Socket pair i links the south end of rank i to the north end of rank
+    // i + 1, wrapping around at the last rank.
+    std::vector<int> fds(procs * 2);
+    for (int i = 0; i < procs; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, &fds[i * 2])) {
+            throw std::runtime_error("socketpair failed: " + std::string(strerror(errno)));
+        }
+    }
+
+    std::vector<pid_t> children;
+    int rank = 0;
+    for (int i = 1; i < procs; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw std::runtime_error("fork failed: " + std::string(strerror(errno)));
+        }
+        if (!pid) {
+            rank = i;
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    int fd_south = fds[rank * 2];
+    int fd_north = fds[((rank + procs - 1) % procs) * 2 + 1];
+    for (int i = 0; i < procs * 2; i++) {
+        if (fds[i] != fd_north && fds[i] != fd_south) {
+            close(fds[i]);
+        }
+    }
+
+    if (rank) {
+        int status = 0;
+        try {
+            dist_transport_socket transport(rank, procs, fd_north, fd_south);
+            func(transport);
+        }
+        catch (const std::exception& e) {
+            fprintf(stderr, "rank %d: %s\n", rank, e.what());
+            status = 1;
+        }
+        catch (...) {
+            fprintf(stderr, "rank %d: unknown exception\n", rank);
+            status = 1;
+        }
+        _exit(status);
+    }
+
+    bool failed = false;
+    try {
+        dist_transport_socket transport(rank, procs, fd_north, fd_south);
+        func(transport);
+    }
+    catch (...) {
+        failed = true;
+    }
+    for (pid_t pid : children) {
+        int status;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+            failed = true;
+        }
+    }
+    if (failed) {
+        throw std::runtime_error("a distributed worker process failed");
+    }
+}
+
+void cpu_dist(char* band, int width, int band_height, int gens, dist_transport& transport, int halo)
+{
+    if (halo < 1) {
+        throw std::invalid_argument("halo must be at least 1");
+    }
+    if (band_height < halo) {
+        throw std::invalid_argument("band_height must be at least halo");
+    }
+    size_t halo_size = (size_t)halo * width;
+    size_t band_size = (size_t)band_height * width;
+    int local_height = band_height + 2 * halo;
+    size_t local_size = (size_t)local_height * width;
+    char* grid = new char[local_size];
+    char* buf = new char[local_size];
+    memcpy(grid + halo_size, band, band_size);
+
+    for (int i = 0; i < gens; i += halo) {
+        // The first and last halo rows of the band go to the neighbors, the
+        // ghost rows around the band come from them.
+        transport.exchange(grid + halo_size, grid + band_size, grid, grid + halo_size + band_size, halo_size);
+
+        // Every generation shrinks the valid region by one row on each side,
+        // so the edge rows are never wrapped around like in the other engines.
+        int steps = std::min(halo, gens - i);
+        for (int s = 1; s <= steps; s++) {
+            for (int y = s; y < local_height - s; y++) {
+                cpu_simd_row(grid, buf, width, y, y - 1, y + 1);
+            }
+            swap_ptr((void**)&grid, (void**)&buf);
+        }
+    }
+
+    memcpy(band, grid + halo_size, band_size);
+    delete[] grid;
+    delete[] buf;
+}
+
+void cpu_dist_local(char* grid, int width, int height, int gens, int procs, int halo)
+{
+    if (height < procs * halo) {
+        throw std::invalid_argument("height must be at least procs * halo");
+    }
+
+    // The world is only shared to hand every process its band and collect the
+    // result. During the simulation, ghost rows move through the sockets.
+    size_t size = (size_t)width * height;
+    char* world = (char*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (world == MAP_FAILED) {
+        throw std::runtime_error("mmap failed: " + std::string(strerror(errno)));
+    }
+    memcpy(world, grid, size);
+
+    try {
+        dist_spawn_local(procs, [&](dist_transport& transport) {
+            int y_start;
+            int rows;
+            dist_band(height, transport.size(), transport.rank(), &y_start, &rows);
+            cpu_dist(world + (size_t)y_start * width, width, rows, gens, transport, halo);
+        });
+    }
+    catch (...) {
+        munmap(world, size);
+        throw;
+    }
+
+    memcpy(grid, world, size);
+    munmap(world, size);
+}
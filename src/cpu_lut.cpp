@@ -0,0 +1,191 @@
+/**
+ * cpu_lut.cpp
+ *
+ * Game of Life with a table that maps 4x4 neighborhoods to the next states of
+ * their 2x2 centers, swept over the world in parallel with OpenMP.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <cctype>
+#include <cstring>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+
+#include <cpu_lut.hpp>
+#include <game_of_life.hpp>
+#include <util.hpp>
+
+void lut_parse_rule(const char* rule, int* birth_mask, int* survive_mask)
+{
+    const std::string error = "rule must be in B/S notation, e.g. B3/S23";
+    int* masks[2] = { birth_mask, survive_mask };
+    const char prefixes[2] = { 'B', 'S' };
+    *birth_mask = 0;
+    *survive_mask = 0;
+
+    for (int i = 0; i < 2; i++) {
+        if (toupper(*rule++) != prefixes[i]) {
+            throw std::invalid_argument(error);
+        }
+        for (; *rule >= '0' && *rule <= '8'; rule++) {
+            *masks[i] |= 1 << (*rule - '0');
+        }
+        if (!i && *rule++ != '/') {
+            throw std::invalid_argument(error);
+        }
+    }
+    if (*rule) {
+        throw std::invalid_argument(error);
+    }
+}
+
+/* Returns the cell at column x and row y of a 4x4 neighborhood. */
+static inline int lut_cell(int index, int x, int y)
+{
+    int block = (y / 2) * 2 + x / 2;
+    int bit = (y % 2) * 2 + x % 2;
+    return (index >> (block * 4 + bit)) & 1;
+}
+
+void lut_build_table(uint8_t* table, int birth_mask, int survive_mask)
+{
+    for (int index = 0; index < lut_table_size; index++) {
+        uint8_t next = 0;
+        for (int y = 1; y <= 2; y++) {
+            for (int x = 1; x <= 2; x++) {
+                int neighbors_count = -lut_cell(index, x, y);
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        neighbors_count += lut_cell(index, x + dx, y + dy);
+                    }
+                }
+                int mask = lut_cell(index, x, y) ? survive_mask : birth_mask;
+                next |= ((mask >> neighbors_count) & 1) << ((y - 1) * 2 + x - 1);
+            }
+        }
+        table[index] = next;
+    }
+}
+
+void lut_encode(const char* grid, uint8_t* blocks, int width, int height)
+{
+    int blocks_width = width / 2;
+    for (int by = 0; by < height / 2; by++) {
+        const char* row = grid + (size_t)by * 2 * width;
+        const char* row_south = row + width;
+        for (int bx = 0; bx < blocks_width; bx++) {
+            blocks[(size_t)by * blocks_width + bx] = row[bx * 2] | row[bx * 2 + 1] << 1 | row_south[bx * 2] << 2 |
+                row_south[bx * 2 + 1] << 3;
+        }
+    }
+}
+
+void lut_decode(const uint8_t* blocks, char* grid, int width, int height, int phase)
+{
+    int blocks_width = width / 2;
+    for (int by = 0; by < height / 2; by++) {
+        int y = by * 2 + phase;
+        char* row = grid + (size_t)y * width;
+        char* row_south = grid + (size_t)((y + 1) % height) * width;
+        for (int bx = 0; bx < blocks_width; bx++) {
+            uint8_t block = blocks[(size_t)by * blocks_width + bx];
+            int x = bx * 2 + phase;
+            int x_east = (x + 1) % width;
+            row[x] = block & 1;
+            row[x_east] = (block >> 1) & 1;
+            row_south[x] = (block >> 2) & 1;
+            row_south[x_east] = (block >> 3) & 1;
+        }
+    }
+}
+
+/* Returns the table for Conway's Game of Life, built on first use. */
+static const uint8_t* lut_conway_table()
+{
+    static uint8_t table[lut_table_size];
+    static bool built = (lut_build_table(table, 1 << 3, 1 << 2 | 1 << 3), true);
+    (void)built;
+    return table;
+}
+
+int cpu_lut_blocks(uint8_t* blocks, int width, int height, int gens, const uint8_t* table)
+{
+    int blocks_width = width / 2;
+    int blocks_height = height / 2;
+    size_t blocks_size = (size_t)blocks_width * blocks_height;
+    uint8_t* buf = new uint8_t[blocks_size];
+
+    for (int i = 0; i < gens; i++) {
+        // From even to odd phase, the neighborhood of a block is itself and
+        // the blocks east, south and southeast of it. From odd to even phase,
+        // it is the blocks northwest, north and west of it and itself.
+        int phase = i % 2;
+        #pragma omp parallel for default(none) \
+        shared(blocks, buf, table, blocks_width, blocks_height, phase)
+        for (int by = 0; by < blocks_height; by++) {
+            uint8_t* out = buf + (size_t)by * blocks_width;
+            const uint8_t* row_north;
+            const uint8_t* row_south;
+            if (!phase) {
+                row_north = blocks + (size_t)by * blocks_width;
+                row_south = blocks + (size_t)(by + 1 == blocks_height ? 0 : by + 1) * blocks_width;
+                for (int bx = 0; bx < blocks_width - 1; bx++) {
+                    out[bx] = table[row_north[bx] | row_north[bx + 1] << 4 | row_south[bx] << 8 |
+                        row_south[bx + 1] << 12];
+                }
+                int bx = blocks_width - 1;
+                out[bx] = table[row_north[bx] | row_north[0] << 4 | row_south[bx] << 8 | row_south[0] << 12];
+            }
+            else {
+                row_north = blocks + (size_t)(by ? by - 1 : blocks_height - 1) * blocks_width;
+                row_south = blocks + (size_t)by * blocks_width;
+                int bx = blocks_width - 1;
+                out[0] = table[row_north[bx] | row_north[0] << 4 | row_south[bx] << 8 | row_south[0] << 12];
+                for (bx = 1; bx < blocks_width; bx++) {
+                    out[bx] = table[row_north[bx - 1] | row_north[bx] << 4 | row_south[bx - 1] << 8 |
+                        row_south[bx] << 12];
+                }
+            }
+        }
+        swap_ptr((void**)&blocks, (void**)&buf);
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to blocks.
+    if (gens % 2) {
+        memcpy(buf, blocks, blocks_size);
+        swap_ptr((void**)&blocks, (void**)&buf);
+    }
+    delete[] buf;
+    return gens % 2;
+}
+
+/* Simulates an encoded copy of the world and decodes the result into it. */
+static void cpu_lut_table(char* grid, int width, int height, int gens, const uint8_t* table)
+{
+    if (width % 2 || height % 2) {
+        throw std::invalid_argument("width and height must be even");
+    }
+    uint8_t* blocks = new uint8_t[(size_t)(width / 2) * (height / 2)];
+    lut_encode(grid, blocks, width, height);
+    int phase = cpu_lut_blocks(blocks, width, height, gens, table);
+    lut_decode(blocks, grid, width, height, phase);
+    delete[] blocks;
+}
+
+void cpu_lut(char* grid, int width, int height, int gens)
+{
+    cpu_lut_table(grid, width, height, gens, lut_conway_table());
+}
+
+void cpu_lut_rule(char* grid, int width, int height, int gens, const char* rule)
+{
+    int birth_mask;
+    int survive_mask;
+    lut_parse_rule(rule, &birth_mask, &survive_mask);
+    uint8_t* table = new uint8_t[lut_table_size];
+    lut_build_table(table, birth_mask, survive_mask);
+    cpu_lut_table(grid, width, height, gens, table);
+    delete[] table;
+}
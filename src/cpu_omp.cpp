@@ -6,14 +6,72 @@
  * Author: Carl Marquez
  * Created on: May 19, 2018
  */
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <omp.h>
 #include <stdexcept>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
+#include <change_stream.hpp>
 #include <cpu_simd.hpp>
+#include <edit_queue.hpp>
 #include <game_of_life.hpp>
+#include <trace.hpp>
+#include <viewport.hpp>
 
-const int cache_line_size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);; 
+/* Returns the line size of the L1 data cache, or 64 bytes if the system does
+not report a power of 2. */
+static int cpu_omp_cache_line_size()
+{
+    long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    return size > 0 && !(size & (size - 1)) ? size : 64;
+}
+
+const int cache_line_size = cpu_omp_cache_line_size();
+
+/* Threads get at least one cache line of cells to prevent false sharing, and
+threads that would get no rows are removed. */
+int cpu_omp_bands(int width, int height, int threads, int* rows_per_thread)
+{
+    *rows_per_thread = (height + threads - 1) / threads;
+    size_t cells_per_thread = (size_t)*rows_per_thread * width;
+    if (cells_per_thread < (size_t)cache_line_size) {
+        *rows_per_thread = (cache_line_size + width - 1) / width;
+    }
+    return (height + *rows_per_thread - 1) / *rows_per_thread;
+}
+
+/* Allocates count counters set to 0 for threads to publish their progress, 
+counter i at i * stride. Counters are aligned to a cache line and one cache 
+line apart, so that polling a counter does not contend with the others. Free
+them with free(). */
+template <class T>
+static std::atomic<T>* cpu_omp_counters(int count, int& stride)
+{
+    stride = (cache_line_size + sizeof(std::atomic<T>) - 1) / sizeof(std::atomic<T>);
+    size_t size = (size_t)count * stride * sizeof(std::atomic<T>);
+    std::atomic<T>* counters = (std::atomic<T>*)aligned_alloc(cache_line_size, 
+        (size + cache_line_size - 1) / cache_line_size * cache_line_size);
+    if (!counters) {
+        throw std::bad_alloc();
+    }
+    for (int i = 0; i < count * stride; i++) {
+        new (&counters[i]) std::atomic<T>(0);
+    }
+    return counters;
+}
+
+/* Waits for every thread of the team at the end of generation gen. */
+static inline void cpu_omp_barrier(int gen)
+{
+    GOL_TRACE_BEGIN("barrier", gen);
+    #pragma omp barrier
+    GOL_TRACE_END();
+}
 
 /* Processes 16 cells simultaneously, multithreaded. */
 static void cpu_omp_simd_16(char* grid, int width, int height, int gens, int threads)
@@ -21,18 +79,11 @@ static void cpu_omp_simd_16(char* grid, int width, int height, int gens, int thr
     if (width < 16) {
         throw std::invalid_argument("width must be at least 16");
     }
-    int size = width * height;
+    size_t size = (size_t)width * height;
     char* buf = new char[size];
 
-    // Threads get at least one cache line of cells to prevent false sharing. 
-    int rows_per_thread = (height + threads - 1) / threads;
-    int cells_per_thread = rows_per_thread * width;
-    if (cells_per_thread < cache_line_size) {
-        rows_per_thread = (cache_line_size + width - 1) / width;
-    }
-
-    // Removes unused threads.
-    threads = (height + rows_per_thread - 1) / rows_per_thread;
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
 
     if (threads == 1) {
         cpu_simd(grid, width, height, gens);
@@ -49,38 +100,44 @@ static void cpu_omp_simd_16(char* grid, int width, int height, int gens, int thr
 
             if (tid == 0) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     cpu_simd_16_row_16w(grid, buf, 0, height - 1, 1);
                     for (int y = 1; y < y_end; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_16_row_16w(grid, buf, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
 
             }
             else if (tid == threads - 1) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end - 1 && y < height - 1; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_16_row_16w(grid, buf, y, y_north, y_south);
                     }
                     cpu_simd_16_row_16w(grid, buf, height - 1, height - 2, 0);
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
             else {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end && y < height; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_16_row_16w(grid, buf, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
         }
@@ -95,37 +152,43 @@ static void cpu_omp_simd_16(char* grid, int width, int height, int gens, int thr
 
             if (tid == 0) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     cpu_simd_16_row(grid, buf, width, 0, height - 1, 1);
                     for (int y = 1; y < y_end; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_16_row(grid, buf, width, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
             else if (tid == threads - 1) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end - 1 && y < height - 1; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_16_row(grid, buf, width, y, y_north, y_south);
                     }
                     cpu_simd_16_row(grid, buf, width, height - 1, height - 2, 0);
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
             else {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end && y < height; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_16_row(grid, buf, width, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
         }
@@ -138,6 +201,78 @@ static void cpu_omp_simd_16(char* grid, int width, int height, int gens, int thr
     delete[] buf;
 }
 
+/* Processes 16 cells simultaneously, multithreaded, without a barrier between
+generations. Every thread computes the first and last rows of its band first
+and publishes them, then computes the rows in between while its neighbors 
+consume the published rows. A thread only waits for its two neighbors to 
+publish the previous generation, so a slow thread delays its neighbors by one
+generation at most instead of stalling every thread. */
+static void cpu_omp_simd_16_overlap(char* grid, int width, int height, int gens, int threads)
+{
+    if (width < 16) {
+        throw std::invalid_argument("width must be at least 16");
+    }
+    size_t size = (size_t)width * height;
+    char* buf = new char[size];
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+
+    if (threads == 1) {
+        cpu_simd(grid, width, height, gens);
+        delete[] buf;
+        return;
+    }
+
+    // Generations published by every thread.
+    int stride;
+    std::atomic<int>* published = cpu_omp_counters<int>(threads, stride);
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(width, height, gens, rows_per_thread, threads, published, stride) firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+        int y_last = y_end - 1;
+        std::atomic<int>& north = published[((tid + threads - 1) % threads) * stride];
+        std::atomic<int>& south = published[((tid + 1) % threads) * stride];
+        std::atomic<int>& self = published[tid * stride];
+
+        for (int i = 0; i < gens; i++) {
+            // Waiting for the neighbors to publish generation i also means 
+            // they are done reading the boundary rows of generation i - 1, 
+            // which are overwritten by this generation.
+            GOL_TRACE_BEGIN("wait", i);
+            while (north.load(std::memory_order_acquire) < i || south.load(std::memory_order_acquire) < i) {
+                _mm_pause();
+            }
+            GOL_TRACE_END();
+
+            GOL_TRACE_BEGIN("band", i);
+            cpu_simd_row(grid, buf, width, y_start, y_start ? y_start - 1 : height - 1, 
+                y_start == height - 1 ? 0 : y_start + 1);
+            if (y_last != y_start) {
+                cpu_simd_row(grid, buf, width, y_last, y_last - 1, y_last == height - 1 ? 0 : y_last + 1);
+            }
+            self.store(i + 1, std::memory_order_release);
+
+            for (int y = y_start + 1; y < y_last; y++) {
+                cpu_simd_row(grid, buf, width, y, y - 1, y + 1);
+            }
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    free(published);
+    delete[] buf;
+}
+
 /* Processes n cells simultaneously, where n is the size of T, multithreaded. */
 template <class T>
 static void cpu_omp_simd_int(char* grid, int width, int height, int gens, int threads)
@@ -146,18 +281,11 @@ static void cpu_omp_simd_int(char* grid, int width, int height, int gens, int th
     if (width < vec_len) {
         throw std::invalid_argument("width must be at least " + std::to_string(vec_len));
     }
-    int size = width * height;
+    size_t size = (size_t)width * height;
     char* buf = new char[size];
 
-    // Threads get at least one cache line of cells to prevent false sharing. 
-    int rows_per_thread = (height + threads - 1) / threads;
-    int cells_per_thread = rows_per_thread * width;
-    if (cells_per_thread < cache_line_size) {
-        rows_per_thread = (cache_line_size + width - 1) / width;
-    }
-
-    // Removes unused threads.
-    threads = (height + rows_per_thread - 1) / rows_per_thread;
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
     if (threads == 1) {
         cpu_simd(grid, width, height, gens);
         return;
@@ -174,38 +302,44 @@ static void cpu_omp_simd_int(char* grid, int width, int height, int gens, int th
 
             if (tid == 0) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     cpu_simd_int_row_intw<T>(grid, buf, 0, height - 1, 1);
                     for (int y = 1; y < y_end; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_int_row_intw<T>(grid, buf, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
 
             }
             else if (tid == threads - 1) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end - 1 && y < height - 1; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_int_row_intw<T>(grid, buf, y, y_north, y_south);
                     }
                     cpu_simd_int_row_intw<T>(grid, buf, height - 1, height - 2, 0);
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
             else {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end && y < height; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_int_row_intw<T>(grid, buf, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
         }
@@ -220,38 +354,44 @@ static void cpu_omp_simd_int(char* grid, int width, int height, int gens, int th
 
             if (tid == 0) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     cpu_simd_int_row<T>(grid, buf, width, 0, height - 1, 1);
                     for (int y = 1; y < y_end; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_int_row<T>(grid, buf, width, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
 
             }
             else if (tid == threads - 1) {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end - 1 && y < height - 1; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_int_row<T>(grid, buf, width, y, y_north, y_south);
                     }
                     cpu_simd_int_row<T>(grid, buf, width, height - 1, height - 2, 0);
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
             else {
                 for (int i = 0; i < gens; i++) {
+                    GOL_TRACE_BEGIN("band", i);
                     for (int y = y_start; y < y_end && y < height; y++) {
                         int y_north = y - 1;
                         int y_south = y + 1;
                         cpu_simd_int_row<T>(grid, buf, width, y, y_north, y_south);
                     }
+                    GOL_TRACE_END();
                     swap_ptr((void**)&grid, (void**)&buf);
-                    #pragma omp barrier
+                    cpu_omp_barrier(i);
                 }
             }
         }
@@ -266,8 +406,53 @@ static void cpu_omp_simd_int(char* grid, int width, int height, int gens, int th
 
 void cpu_omp(char* grid, int width, int height, int gens)
 {
-    int threads = omp_get_num_procs();
-    if (width >= 16) {
+    cpu_omp_threads(grid, width, height, gens, omp_get_num_procs());
+}
+
+/* Processes rows of a width with a fixed width kernel, multithreaded. */
+static void cpu_omp_fixed(char* grid, int width, int height, int gens, int threads, 
+    cpu_simd_fixed_rows_t rows)
+{
+    size_t size = (size_t)width * height;
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+    if (threads == 1) {
+        cpu_simd(grid, width, height, gens);
+        return;
+    }
+    char* buf = new char[size];
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(height, gens, rows_per_thread, rows) firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+
+        for (int i = 0; i < gens; i++) {
+            GOL_TRACE_BEGIN("band", i);
+            rows(grid, buf, height, y_start, y_end);
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+            cpu_omp_barrier(i);
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
+void cpu_omp_threads(char* grid, int width, int height, int gens, int threads)
+{
+    cpu_simd_fixed_rows_t fixed_rows = cpu_simd_fixed_rows_for(width);
+    if (fixed_rows) {
+        cpu_omp_fixed(grid, width, height, gens, threads, fixed_rows);
+    }
+    else if (width >= 16) {
         cpu_omp_simd_16(grid, width, height, gens, threads);
     }
     else if (width >= 8) {
@@ -283,3 +468,459 @@ void cpu_omp(char* grid, int width, int height, int gens)
         cpu_omp_simd_int<uint8_t>(grid, width, height, gens, threads);
     }
 }
+
+void cpu_omp_overlap(char* grid, int width, int height, int gens, int threads)
+{
+    if (width >= 16) {
+        cpu_omp_simd_16_overlap(grid, width, height, gens, threads);
+    }
+    else {
+        cpu_omp_threads(grid, width, height, gens, threads);
+    }
+}
+
+// Cells of a chunk of rows computed between two waits of a pipelined thread,
+// chunks of rows in the window of every generation between two threads, and
+// spins before a waiting thread yields its processor.
+const int pipeline_chunk_cells = 4096;
+const int pipeline_window_chunks = 4;
+const int pipeline_spins = 1 << 12;
+
+/* Waits until a thread of the pipeline published at least rows rows. Threads
+wait for each other on every chunk, so a waiting thread yields once the thread
+it waits for is unlikely to be running, such as when there are more threads 
+than processors. */
+static inline void cpu_omp_pipeline_wait(const std::atomic<int64_t>& published, int64_t rows)
+{
+    for (int spins = 0; published.load(std::memory_order_acquire) < rows; spins++) {
+        if (spins < pipeline_spins) {
+            _mm_pause();
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void cpu_omp_pipeline(char* grid, int width, int height, int gens, int threads)
+{
+    // A group of generations needs a stage after the first one to write the 
+    // last generation back into the world.
+    threads = std::min(threads, gens);
+    if (threads < 2 || height < 3) {
+        cpu_simd(grid, width, height, gens);
+        return;
+    }
+
+    // Stage k of a group computes generation k + 1 of rows k + 1 to 
+    // height + k in order, wrapping around past the last row, so that every
+    // row it needs from generation k is one stage k - 1 already computed or
+    // is about to. Generations between stages are kept in a window of 
+    // window_rows rows, row y at y % window_rows, and the first two rows of
+    // every generation are kept after the window for the last two rows of the
+    // next stage. Windows are aligned to 16 bytes for rows of 16 width.
+    int chunk_rows = std::max(1, pipeline_chunk_cells / width);
+    int window_rows = chunk_rows * pipeline_window_chunks;
+    size_t window_size = ((size_t)(window_rows + 2) * width + 15) & ~(size_t)15;
+    char* windows = (char*)aligned_alloc(16, window_size * (threads - 1));
+    if (!windows) {
+        throw std::bad_alloc();
+    }
+
+    // Rows published by every stage since the first group.
+    int stride;
+    std::atomic<int64_t>* published = cpu_omp_counters<int64_t>(threads, stride);
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(grid, width, height, gens, threads, chunk_rows, window_rows, window_size, windows, published, stride)
+    {
+        int tid = omp_get_thread_num();
+        for (int gen = 0, group = 0; gen < gens; gen += threads, group++) {
+            int stages = std::min(threads, gens - gen);
+            if (stages == 1) {
+                #pragma omp single
+                cpu_simd(grid, width, height, 1);
+                continue;
+            }
+            if (tid >= stages) {
+                cpu_omp_barrier(gen);
+                continue;
+            }
+
+            // The first stage reads the world and the last one writes it, 
+            // which is safe as a row of the world is only written once the 
+            // first stage is done with it.
+            int k = tid;
+            char* in = k ? windows + (k - 1) * window_size : grid;
+            char* out = k < stages - 1 ? windows + k * window_size : grid;
+            int64_t base = (int64_t)group * height;
+            std::atomic<int64_t>* before = k ? &published[(k - 1) * stride] : nullptr;
+            std::atomic<int64_t>* after = k < stages - 1 ? &published[(k + 1) * stride] : nullptr;
+            std::atomic<int64_t>& self = published[k * stride];
+
+            int in_rows = k ? window_rows : height;
+            int out_rows = out == grid ? height : window_rows;
+
+            // Returns where row y of the generation the stage reads is, given
+            // where row y - 1 is, without a division for every row.
+            auto in_next = [&](int y, int i_prev) {
+                if (k && y >= height + k) {
+                    return window_rows + y - (height + k);
+                }
+                return i_prev + 1 == in_rows ? 0 : i_prev + 1;
+            };
+
+            GOL_TRACE_BEGIN("stage", gen + k);
+            for (int j_start = 0; j_start < height; j_start += chunk_rows) {
+                int j_end = std::min(j_start + chunk_rows, height);
+
+                // The stage before must have computed the rows south of the 
+                // chunk, and the stage after must be done with the rows the
+                // chunk overwrites in the window.
+                if (before) {
+                    cpu_omp_pipeline_wait(*before, base + std::min(j_end + 2, height));
+                }
+                if (after && j_end > window_rows) {
+                    cpu_omp_pipeline_wait(*after, base + j_end - window_rows);
+                }
+
+                int y = j_start + k + 1;
+                int i_north = (y - 1) % in_rows;
+                int i_row = in_next(y, i_north);
+                int i_south = in_next(y + 1, i_row);
+                int i_out = y % out_rows;
+                for (int j = j_start; j < j_end; j++, y++) {
+                    char* p_out = out + (size_t)i_out * width;
+                    cpu_simd_row_at(in + (size_t)i_north * width, in + (size_t)i_row * width, 
+                        in + (size_t)i_south * width, p_out, width);
+                    if (out != grid && j < 2) {
+                        memcpy(out + (size_t)(window_rows + j) * width, p_out, width);
+                    }
+                    i_north = i_row;
+                    i_row = i_south;
+                    i_south = in_next(y + 2, i_south);
+                    i_out = i_out + 1 == out_rows ? 0 : i_out + 1;
+                }
+                self.store(base + j_end, std::memory_order_release);
+            }
+            GOL_TRACE_END();
+            cpu_omp_barrier(gen);
+        }
+    }
+
+    free(published);
+    free(windows);
+}
+
+void cpu_omp_rowsum(char* grid, int width, int height, int gens)
+{
+    int threads = omp_get_num_procs();
+    size_t size = (size_t)width * height;
+    char* buf = new char[size];
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+
+    // Every thread walks the column strips of its own band, the rows north 
+    // and south of the band are only read.
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(width, height, gens, rows_per_thread) firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+
+        for (int i = 0; i < gens; i++) {
+            GOL_TRACE_BEGIN("band", i);
+            cpu_simd_rowsum_rows(grid, buf, width, height, y_start, y_end);
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+            cpu_omp_barrier(i);
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
+void cpu_omp_view(char* grid, int width, int height, int gens, const viewport& view, viewport_ring& ring,
+    int period)
+{
+    viewport_check(view, width, height);
+    if (period < 1) {
+        throw std::invalid_argument("period must be at least 1");
+    }
+    if (ring.frame_width() != view.frame_width() || ring.frame_height() != view.frame_height()) {
+        throw std::invalid_argument("ring frames must be the size of the viewport frames");
+    }
+    int threads = omp_get_num_procs();
+    size_t size = (size_t)width * height;
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+    char* buf = new char[size];
+
+    // Alive cells of every pixel, in two sets so that the master thread draws
+    // a frame from one while the rows of the next frame are counted into the
+    // other. A pixel row split between two bands is counted by both threads.
+    int frame_width = view.frame_width();
+    size_t pixels = (size_t)frame_width * view.frame_height();
+    std::vector<uint32_t> counts(2 * pixels);
+    uint32_t* counts_ptr = counts.data();
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(width, height, gens, rows_per_thread, view, ring, period, frame_width, pixels, counts_ptr) \
+    firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+        int view_start = std::max(y_start, view.y);
+        int view_end = std::min(y_end, view.y + view.height);
+        std::vector<uint32_t> row_counts(frame_width);
+
+        for (int i = 0; i < gens; i++) {
+            bool frame = (i + 1) % period == 0;
+            uint32_t* frame_counts = counts_ptr + (size_t)(i / period % 2) * pixels;
+
+            GOL_TRACE_BEGIN("band", i);
+            for (int y = y_start; y < y_end; y++) {
+                cpu_simd_row(grid, buf, width, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+
+                // Rows of the viewport are counted while they are still in
+                // L1, and added to the frame at the end of every pixel row.
+                if (!frame || y < view_start || y >= view_end) {
+                    continue;
+                }
+                viewport_add_row(view, buf + (size_t)y * width, row_counts.data());
+                if ((y - view.y + 1) % view.scale && y != view_end - 1) {
+                    continue;
+                }
+                uint32_t* pixel_row = frame_counts + (size_t)((y - view.y) / view.scale) * frame_width;
+                for (int px = 0; px < frame_width; px++) {
+                    __atomic_fetch_add(&pixel_row[px], row_counts[px], __ATOMIC_RELAXED);
+                    row_counts[px] = 0;
+                }
+            }
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+            cpu_omp_barrier(i);
+
+            // The other threads go on with the next generations meanwhile.
+            if (frame) {
+                #pragma omp master
+                {
+                    viewport_draw(view, frame_counts, ring.begin_frame());
+                    ring.publish(i + 1);
+                    std::fill(frame_counts, frame_counts + pixels, 0);
+                }
+            }
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
+void cpu_omp_edit(char* grid, int width, int height, int gens, edit_queue& edits)
+{
+    int threads = omp_get_num_procs();
+    size_t size = (size_t)width * height;
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+    char* buf = new char[size];
+
+    // Edits made before the call apply to the first generation. The batch
+    // taken at the end of every generation is applied by every thread to its
+    // rows of the next one, while the master thread takes the batch after it
+    // into the other slot.
+    edit_batch first = edits.take();
+    edit_batch batches[2];
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(width, height, gens, rows_per_thread, edits, first, batches) firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+
+        // Rows of the neighbors are read by the first generation, so every
+        // thread waits for the others to edit their rows.
+        if (!first.empty()) {
+            first.apply(grid, width, height, y_start, y_end);
+            #pragma omp barrier
+        }
+
+        for (int i = 0; i < gens; i++) {
+            GOL_TRACE_BEGIN("band", i);
+            for (int y = y_start; y < y_end; y++) {
+                cpu_simd_row(grid, buf, width, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0);
+            }
+            batches[i % 2].apply(buf, width, height, y_start, y_end);
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+
+            // Every thread applied the batch in the other slot before the
+            // last barrier, so it can be replaced. The last generation leaves
+            // the edits in the queue.
+            if (i + 1 < gens) {
+                #pragma omp master
+                batches[(i + 1) % 2] = edits.take();
+            }
+            cpu_omp_barrier(i);
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
+/* Writes the entries of the cells of a row that changed from old to next to 
+out, 16 cells at a time. out is moved past the entries written. */
+static inline void cpu_omp_row_diff(const char* old, const char* next, size_t i_row, int width, uint64_t*& out)
+{
+    for (int x = 0; x < width; x += 16) {
+        unsigned changed = 0;
+        for (int b = 0; b < 16 && x + b < width; b++) {
+            changed |= (unsigned)(old[x + b] ^ next[x + b]) << b;
+        }
+        *out = change_entry(i_row + x, changed);
+        out += changed != 0;
+    }
+}
+
+#if defined __SSE2__ && defined __SSSE3__
+/* Returns a bit for every cell of next that is not the same in cells. Cells 
+are 0 or 1, so the low bit of every byte is moved to the sign bit. */
+static inline unsigned cpu_omp_changed_bits(__m128i cells, __m128i next)
+{
+    return _mm_movemask_epi8(_mm_slli_epi16(_mm_xor_si128(cells, next), 7));
+}
+#endif
+
+/* Processes a row like cpu_simd_row() and writes the entries of the cells of 
+it that changed to out, which is moved past them. Rows wider than 16 are 
+compared a vector at a time while the next states are still in a register. An
+entry is written for every vector and only kept if a cell of it changed, so 
+there is no branch on the changes. */
+static inline void cpu_omp_row_changes(char* grid, char* buf, int width, int y, int y_north, int y_south, 
+    uint64_t*& out)
+{
+    size_t i_row = (size_t)y * width;
+#if defined __SSE2__ && defined __SSSE3__
+    if (width > 16) {
+        char* p_north = grid + (size_t)y_north * width;
+        char* p_row = grid + i_row;
+        char* p_south = grid + (size_t)y_south * width;
+        char* p_buf = buf + i_row;
+
+        __m128i next = cpu_simd_16_vec_first(p_north, p_row, p_south, width);
+        unsigned changed = cpu_omp_changed_bits(_mm_loadu_si128((__m128i*)p_row), next);
+        _mm_storeu_si128((__m128i*)p_buf, next);
+        *out = change_entry(i_row, changed);
+        out += changed != 0;
+        int x = 16;
+        for (; x < width - 16; x += 16) {
+            next = cpu_simd_16_vec_middle(p_north, p_row, p_south, x);
+            changed = cpu_omp_changed_bits(_mm_loadu_si128((__m128i*)(p_row + x)), next);
+            _mm_storeu_si128((__m128i*)(p_buf + x), next);
+            *out = change_entry(i_row + x, changed);
+            out += changed != 0;
+        }
+
+        // The last vector overlaps the one before it if the width is not a 
+        // multiple of 16, the cells of both are only in the entry before.
+        next = cpu_simd_16_vec_last(p_north, p_row, p_south, width);
+        changed = cpu_omp_changed_bits(_mm_loadu_si128((__m128i*)(p_row + width - 16)), next);
+        changed &= 0xffff << (x - (width - 16));
+        _mm_storeu_si128((__m128i*)(p_buf + width - 16), next);
+        *out = change_entry(i_row + width - 16, changed);
+        out += changed != 0;
+        return;
+    }
+#endif
+    cpu_simd_row(grid, buf, width, y, y_north, y_south);
+    cpu_omp_row_diff(grid + i_row, buf + i_row, i_row, width, out);
+}
+
+void cpu_omp_changes(char* grid, int width, int height, int gens, change_stream& changes)
+{
+    int threads = omp_get_num_procs();
+    size_t size = (size_t)width * height;
+
+    int rows_per_thread;
+    threads = cpu_omp_bands(width, height, threads, &rows_per_thread);
+    char* buf = new char[size];
+
+    // Entries of the band of every thread, and where they start in the
+    // entries of the generation. A row has at most an entry for every 16
+    // cells, and one more for the last vector of rows that are not a 
+    // multiple of 16 wide.
+    std::vector<std::vector<uint64_t>> thread_changes(threads);
+    std::vector<size_t> counts(threads);
+    std::vector<size_t> offsets(threads);
+    size_t row_entries = width / 16 + 1;
+    uint64_t* merged = nullptr;
+
+    // Threads done with their band in this generation.
+    std::atomic<int> done(0);
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(width, height, gens, rows_per_thread, threads, changes, thread_changes, counts, offsets, merged, \
+    row_entries, done) \
+    firstprivate(grid, buf)
+    {
+        int tid = omp_get_thread_num();
+        int y_start = tid * rows_per_thread;
+        int y_end = std::min(y_start + rows_per_thread, height);
+        std::vector<uint64_t>& own = thread_changes[tid];
+        own.resize(std::max(0, y_end - y_start) * row_entries);
+
+        for (int i = 0; i < gens; i++) {
+            GOL_TRACE_BEGIN("band", i);
+            uint64_t* out = own.data();
+            for (int y = y_start; y < y_end; y++) {
+                cpu_omp_row_changes(grid, buf, width, y, y ? y - 1 : height - 1, y < height - 1 ? y + 1 : 0, out);
+            }
+            counts[tid] = out - own.data();
+            GOL_TRACE_END();
+            swap_ptr((void**)&grid, (void**)&buf);
+
+            // Bands are in cell order, so the generation is the entries of
+            // every band one after the other. The last thread done with its
+            // band adds the generation before the barrier, so the barrier
+            // also waits for it. After the barrier, every thread copies its
+            // own entries and goes on with the next generation without
+            // waiting for the others to copy theirs. The next generation is
+            // only added once every thread is done with its next band, so
+            // after every thread copied.
+            if (done.fetch_add(1, std::memory_order_acq_rel) == threads - 1) {
+                size_t count = 0;
+                for (int t = 0; t < threads; t++) {
+                    offsets[t] = count;
+                    count += counts[t];
+                }
+                merged = changes.append(count);
+                done.store(0, std::memory_order_relaxed);
+            }
+            cpu_omp_barrier(i);
+            std::copy(own.data(), own.data() + counts[tid], merged + offsets[tid]);
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
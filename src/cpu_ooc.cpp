@@ -0,0 +1,404 @@
+/**
+ * cpu_ooc.cpp
+ *
+ * Out-of-core Game of Life. Bands are streamed from one file to another and
+ * back, with the next band read and the last band written by an I/O thread
+ * while the current band is simulated. In memory, a band is padded with halo
+ * ghost rows on each side like in cpu_dist, so it can be advanced halo
+ * generations with the SIMD row kernels without seeing the rest of the world.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <mutex>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <bitpack.hpp>
+#include <cpu_ooc.hpp>
+#include <cpu_simd.hpp>
+#include <util.hpp>
+
+// Cells packed or unpacked at a time when a whole world is written or read.
+const size_t ooc_chunk_cells = 1 << 20;
+
+/* Reads bytes at offset, throws if the file ends before. */
+static void read_all(int fd, char* data, size_t bytes, off_t offset)
+{
+    while (bytes) {
+        ssize_t n = pread(fd, data, bytes, offset);
+        if (!n) {
+            throw std::runtime_error("unexpected end of world file");
+        }
+        if (n < 0 && errno != EINTR) {
+            throw std::runtime_error("pread failed: " + std::string(strerror(errno)));
+        }
+        if (n > 0) {
+            data += n;
+            bytes -= n;
+            offset += n;
+        }
+    }
+}
+
+/* Writes bytes at offset. */
+static void write_all(int fd, const char* data, size_t bytes, off_t offset)
+{
+    while (bytes) {
+        ssize_t n = pwrite(fd, data, bytes, offset);
+        if (n < 0 && errno != EINTR) {
+            throw std::runtime_error("pwrite failed: " + std::string(strerror(errno)));
+        }
+        if (n > 0) {
+            data += n;
+            bytes -= n;
+            offset += n;
+        }
+    }
+}
+
+static int open_world(const char* path, int flags)
+{
+    int fd = open(path, flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + std::string(path) + ": " + std::string(strerror(errno)));
+    }
+    return fd;
+}
+
+/* Runs reads and writes on a thread of its own in the order they were
+submitted. Every request gets a ticket, and waiting for a ticket waits for
+that request and every request before it. */
+class ooc_io_thread
+{
+private:
+    struct request
+    {
+        int fd;
+        char* data;
+        size_t bytes;
+        off_t offset;
+        bool write;
+    };
+
+    std::mutex _mutex;
+    std::condition_variable _submitted;
+    std::condition_variable _completed;
+    std::deque<request> _requests;
+    uint64_t _submitted_count;
+    uint64_t _completed_count;
+    std::exception_ptr _error;
+    bool _stop;
+    std::thread _thread;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _submitted.wait(lock, [this]() { return _stop || !_requests.empty(); });
+            if (_requests.empty()) {
+                return;
+            }
+            request req = _requests.front();
+            _requests.pop_front();
+            bool failed = (bool)_error;
+            lock.unlock();
+
+            // Requests after a failed one are skipped, the error is thrown by
+            // the next wait.
+            std::exception_ptr error;
+            if (!failed) {
+                try {
+                    if (req.write) {
+                        write_all(req.fd, req.data, req.bytes, req.offset);
+                    }
+                    else {
+                        read_all(req.fd, req.data, req.bytes, req.offset);
+                    }
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if (error) {
+                _error = error;
+            }
+            _completed_count++;
+            _completed.notify_all();
+        }
+    }
+
+    uint64_t submit(const request& req)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requests.push_back(req);
+        _submitted.notify_one();
+        return ++_submitted_count;
+    }
+
+public:
+    ooc_io_thread() : _submitted_count(0), _completed_count(0), _stop(false), _thread(&ooc_io_thread::run, this) {};
+
+    /* Finishes every submitted request before returning. */
+    ~ooc_io_thread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+            _submitted.notify_one();
+        }
+        _thread.join();
+    };
+
+    uint64_t read(int fd, char* data, size_t bytes, off_t offset)
+    {
+        return submit(request{fd, data, bytes, offset, false});
+    };
+
+    uint64_t write(int fd, const char* data, size_t bytes, off_t offset)
+    {
+        return submit(request{fd, (char*)data, bytes, offset, true});
+    };
+
+    /* Waits for the request with ticket and every request before it. Ticket 0
+    returns immediately. */
+    void wait(uint64_t ticket)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _completed.wait(lock, [this, ticket]() { return _completed_count >= ticket; });
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    };
+};
+
+/* Reads count rows starting at row y, wrapped around the world as often as
+needed, into data. Returns the ticket of the last read. */
+static uint64_t read_rows_wrapped(ooc_io_thread& io, int fd, char* data, int width, int height, int y,
+    int count)
+{
+    size_t row_bytes = width / 8;
+    uint64_t ticket = 0;
+    y = (y % height + height) % height;
+    while (count) {
+        int rows = std::min(count, height - y);
+        ticket = io.read(fd, data, (size_t)rows * row_bytes, (off_t)y * row_bytes);
+        data += (size_t)rows * row_bytes;
+        count -= rows;
+        y = 0;
+    }
+    return ticket;
+}
+
+static void check_width(int width)
+{
+    if (width % 32) {
+        throw std::invalid_argument("width must be a multiple of 32");
+    }
+}
+
+void ooc_write_world(const char* path, const char* grid, int width, int height)
+{
+    check_width(width);
+    int fd = open_world(path, O_WRONLY | O_CREAT | O_TRUNC);
+    int chunk_rows = std::max((size_t)1, ooc_chunk_cells / width);
+    std::vector<uint32_t> bits((size_t)chunk_rows * width / 32);
+
+    try {
+        for (int y = 0; y < height; y += chunk_rows) {
+            int rows = std::min(chunk_rows, height - y);
+            pack_cells(grid + (size_t)y * width, bits.data(), (size_t)rows * width);
+            write_all(fd, (char*)bits.data(), (size_t)rows * width / 8, (off_t)y * (width / 8));
+        }
+    }
+    catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+void ooc_read_world(const char* path, char* grid, int width, int height)
+{
+    check_width(width);
+    int fd = open_world(path, O_RDONLY);
+    int chunk_rows = std::max((size_t)1, ooc_chunk_cells / width);
+    std::vector<uint32_t> bits((size_t)chunk_rows * width / 32);
+
+    try {
+        for (int y = 0; y < height; y += chunk_rows) {
+            int rows = std::min(chunk_rows, height - y);
+            read_all(fd, (char*)bits.data(), (size_t)rows * width / 8, (off_t)y * (width / 8));
+            unpack_cells(bits.data(), grid + (size_t)y * width, (size_t)rows * width);
+        }
+    }
+    catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+int ooc_band_rows(int width, int halo, size_t memory)
+{
+    // Every padded row is in the two cell buffers and the two packed read
+    // buffers, every row of the band itself also in the two packed write
+    // buffers.
+    size_t padded_row = (size_t)width * 2 + width / 4;
+    size_t band_row = padded_row + width / 4;
+    size_t ghosts = padded_row * 2 * halo;
+    if (memory < ghosts + band_row) {
+        throw std::invalid_argument("memory must fit a band of at least one row and its ghost rows");
+    }
+    return (int)std::min((memory - ghosts) / band_row, (size_t)INT_MAX);
+}
+
+void cpu_ooc_file(const char* path, int width, int height, int gens, size_t memory, int halo)
+{
+    check_width(width);
+    if (halo < 1) {
+        throw std::invalid_argument("halo must be at least 1");
+    }
+    int band_rows = std::min(ooc_band_rows(width, halo, memory), height);
+    int bands = (height + band_rows - 1) / band_rows;
+    int passes = (gens + halo - 1) / halo;
+    int tasks = passes * bands;
+    size_t row_bytes = width / 8;
+    size_t local_size = (size_t)(band_rows + 2 * halo) * width;
+    size_t band_words = (size_t)band_rows * width / 32;
+
+    // Passes go back and forth between the file at path and the next file.
+    std::string next_path = std::string(path) + ".next";
+    int fds[2];
+    fds[0] = open_world(path, O_RDWR);
+    try {
+        fds[1] = open_world(next_path.c_str(), O_RDWR | O_CREAT | O_TRUNC);
+    }
+    catch (...) {
+        close(fds[0]);
+        throw;
+    }
+
+    std::vector<char> cells(local_size * 2);
+    std::vector<uint32_t> reads(local_size / 32 * 2);
+    std::vector<uint32_t> writes(band_words * 2);
+    try {
+        // Declared after the buffers, so that requests still in flight when
+        // an exception is thrown finish before the buffers are freed.
+        ooc_io_thread io;
+        uint64_t read_tickets[2] = { 0, 0 };
+        uint64_t write_tickets[2] = { 0, 0 };
+
+        auto prefetch = [&](int t) {
+            int y_start = (t % bands) * band_rows;
+            int rows = std::min(band_rows, height - y_start);
+            read_tickets[t % 2] = read_rows_wrapped(io, fds[t / bands % 2], (char*)(reads.data() + 
+                t % 2 * (local_size / 32)), width, height, y_start - halo, rows + 2 * halo);
+        };
+
+        if (tasks) {
+            prefetch(0);
+        }
+        for (int t = 0; t < tasks; t++) {
+            int pass = t / bands;
+            int y_start = (t % bands) * band_rows;
+            int rows = std::min(band_rows, height - y_start);
+            int local_height = rows + 2 * halo;
+            int steps = std::min(halo, gens - pass * halo);
+
+            // The next band of the pass is read while this one is simulated.
+            // The first band of the next pass needs the last band of this
+            // pass, so it is only read after that has been written.
+            bool prefetch_now = t + 1 < tasks && (t + 1) / bands == pass;
+            if (prefetch_now) {
+                prefetch(t + 1);
+            }
+
+            io.wait(read_tickets[t % 2]);
+            char* grid = cells.data();
+            char* buf = grid + local_size;
+            unpack_cells(reads.data() + t % 2 * (local_size / 32), grid, (size_t)local_height * width);
+
+            // Every generation shrinks the valid region by one row on each
+            // side, the band itself is still valid after halo generations.
+            for (int s = 1; s <= steps; s++) {
+                #pragma omp parallel for default(none) shared(grid, buf, width, local_height, s)
+                for (int y = s; y < local_height - s; y++) {
+                    cpu_simd_row(grid, buf, width, y, y - 1, y + 1);
+                }
+                swap_ptr((void**)&grid, (void**)&buf);
+            }
+
+            // The write buffer was last used two bands ago, which is written
+            // while the last band was simulated.
+            uint32_t* out = writes.data() + t % 2 * band_words;
+            io.wait(write_tickets[t % 2]);
+            pack_cells(grid + (size_t)halo * width, out, (size_t)rows * width);
+            write_tickets[t % 2] = io.write(fds[(pass + 1) % 2], (char*)out, (size_t)rows * row_bytes, 
+                (off_t)y_start * row_bytes);
+
+            if (!prefetch_now && t + 1 < tasks) {
+                prefetch(t + 1);
+            }
+        }
+        if (tasks) {
+            io.wait(write_tickets[(tasks - 1) % 2]);
+        }
+    }
+    catch (...) {
+        close(fds[0]);
+        close(fds[1]);
+        unlink(next_path.c_str());
+        throw;
+    }
+    close(fds[0]);
+    close(fds[1]);
+
+    // If number of passes is odd, the result is in the next file.
+    if (passes % 2) {
+        if (rename(next_path.c_str(), path)) {
+            throw std::runtime_error("cannot replace " + std::string(path) + ": " + std::string(strerror(errno)));
+        }
+    }
+    else {
+        unlink(next_path.c_str());
+    }
+}
+
+void cpu_ooc(char* grid, int width, int height, int gens, size_t memory, int halo)
+{
+    check_width(width);
+    const char* tmpdir = getenv("TMPDIR");
+    std::string path = std::string(tmpdir && *tmpdir ? tmpdir : "/tmp") + "/game_of_life_XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("cannot create temporary file: " + std::string(strerror(errno)));
+    }
+    close(fd);
+
+    try {
+        ooc_write_world(path.c_str(), grid, width, height);
+        cpu_ooc_file(path.c_str(), width, height, gens, memory, halo);
+        ooc_read_world(path.c_str(), grid, width, height);
+    }
+    catch (...) {
+        unlink(path.c_str());
+        throw;
+    }
+    unlink(path.c_str());
+}
@@ -8,56 +8,13 @@
  */
 #include <cstring>
 
+#include <cpu_seq.hpp>
 #include <game_of_life.hpp>
 #include <util.hpp>
 
-/* Processes cells in a row. */
-static inline void cpu_seq_row(char* grid, char* buf, int width, int y, int ynorth, int ysouth)
-{
-    int i_row = y * width;
-    int i_north = ynorth * width;
-    int i_south = ysouth * width;
-
-    // First cell is a special case because the west neighbors wrap around. 
-    int x = 0;
-    int idx = i_row;
-    int x_west = width - 1;
-    int x_east = 1;
-    char cell = grid[i_north + x_west] + grid[i_north] + 
-                grid[i_north + x_east] + grid[i_row + x_west] + 
-                grid[i_row + x_east] + grid[i_south + x_west] + 
-                grid[i_south] + grid[i_south + x_east];
-    cell = (cell == 3) | ((cell == 2) & grid[i_row]);
-    buf[i_row] = cell;
-    
-    // Middle cells
-    for (x = 1; x < width - 1; x++) {
-        idx = i_row + x;
-        x_west = x - 1;
-        x_east = x + 1;
-        cell = grid[i_north + x_west] + grid[i_north + x] + 
-               grid[i_north + x_east] + grid[i_row + x_west] + 
-               grid[i_row + x_east] + grid[i_south + x_west] + 
-               grid[i_south + x] + grid[i_south + x_east];
-        cell = (cell == 3) | ((cell == 2) & grid[idx]);
-        buf[idx] = cell;
-    }
-
-    // Last cell is a special case because the east neighbors wrap around.
-    x = width - 1;
-    idx = i_row + x;
-    x_west = width - 2;
-    x_east = 0;
-    cell = grid[i_north + x_west] + grid[i_north + x] + grid[i_north + x_east] + 
-           grid[i_row + x_west] + grid[i_row + x_east] + 
-           grid[i_south + x_west] + grid[i_south + x] + grid[i_south + x_east];
-    cell = (cell == 3) | ((cell == 2) & grid[idx]);
-    buf[idx] = cell;
-}
-
 void cpu_seq(char* grid, int width, int height, int gens)
 {
-    int size = width * height;
+    size_t size = (size_t)width * height;
     char* buf = new char[size];
     
     for (int i = 0; i < gens; i++) {
@@ -21,7 +21,7 @@ void cpu_simd_16(char* grid, int width, int height, int gens)
     if (width < 16) {
         throw std::invalid_argument("width must be at least 16");
     }
-    int size = width * height;
+    size_t size = (size_t)width * height;
     char* buf = new char[size];
 
     // Width of 16 handled separately because it can be optimized further.
@@ -58,13 +58,37 @@ void cpu_simd_16(char* grid, int width, int height, int gens)
     delete[] buf;
 }
 
+/* Processes rows of a width with a fixed width kernel. */
+static void cpu_simd_fixed(char* grid, int width, int height, int gens, cpu_simd_fixed_rows_t rows)
+{
+    size_t size = (size_t)width * height;
+    char* buf = new char[size];
+
+    for (int i = 0; i < gens; i++) {
+        rows(grid, buf, height, 0, height);
+        swap_ptr((void**)&grid, (void**)&buf);
+    }
+
+    // If number of generations is odd, the result is in buf, so swap with grid. 
+    if (gens % 2) { 
+        swap_ptr((void**)&grid, (void**)&buf);
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
+
 /* Game of Life CPU SIMD
 
-Different width ranges are handled separately to maximize vector size for 
-maximum parallelism without overrunning a row (vector size > width). */ 
+Widths with a fixed width kernel use it. Other width ranges are handled 
+separately to maximize vector size for maximum parallelism without overrunning
+a row (vector size > width). */ 
 void cpu_simd(char* grid, int width, int height, int gens)
 {
-    if (width >= 16) {
+    cpu_simd_fixed_rows_t fixed_rows = cpu_simd_fixed_rows_for(width);
+    if (fixed_rows) {
+        cpu_simd_fixed(grid, width, height, gens, fixed_rows);
+    }
+    else if (width >= 16) {
         cpu_simd_16(grid, width, height, gens);
     }
     else if (width >= 8) {
@@ -80,3 +104,25 @@ void cpu_simd(char* grid, int width, int height, int gens)
         cpu_simd_int<uint8_t>(grid, width, height, gens);
     }
 }
+
+/* Game of Life CPU SIMD with row-sum reuse
+
+Same width ranges as cpu_simd, but every row is loaded once per column strip 
+instead of three times. See cpu_simd_rowsum_rows(). */
+void cpu_simd_rowsum(char* grid, int width, int height, int gens)
+{
+    size_t size = (size_t)width * height;
+    char* buf = new char[size];
+
+    for (int i = 0; i < gens; i++) {
+        cpu_simd_rowsum_rows(grid, buf, width, height, 0, height);
+        swap_ptr((void**)&grid, (void**)&buf);
+    }
+
+    // If number of generations is odd, the result is in buf, so swap with grid. 
+    if (gens % 2) { 
+        swap_ptr((void**)&grid, (void**)&buf);
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+}
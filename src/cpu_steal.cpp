@@ -0,0 +1,238 @@
+/**
+ * cpu_steal.cpp
+ *
+ * Multi-threaded SIMD Game of Life where the world is split into tiles that
+ * threads take from their own deques and steal from each other's. A tile 
+ * advances to the next generation as soon as it and its 8 neighboring tiles
+ * have finished the current one, so there is no barrier between generations
+ * and a slow thread only holds back the tiles around the ones it is working
+ * on.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <omp.h>
+#include <vector>
+
+#include <cpu_simd.hpp>
+#include <game_of_life.hpp>
+#include <util.hpp>
+
+// Tile width in cache lines and tile height in rows. Tile starts within a row
+// are a whole number of cache lines apart, so no two tiles write to the same
+// line only when width is a multiple of the cache line size. Otherwise tiles
+// may share a line at their edges, which costs false sharing but is still
+// correct since each cell is written by one tile.
+const int tile_width_lines = 32;
+const int tile_height = 32;
+
+struct steal_tile
+{
+    int x_start;
+    int x_end;
+    int y_start;
+    int y_end;
+
+    // Generations computed so far. Only touched by the thread running the
+    // tile, which is handed over through the deques.
+    int gen;
+
+    // Distinct neighboring tiles including the tile itself, fewer than 9 when
+    // the world is only one or two tiles wide or high.
+    int neighbors[9];
+    int neighbors_count;
+
+    // Neighbors that have finished the generation before the next one of this
+    // tile, indexed by the parity of that generation.
+    std::atomic<int> ready[2];
+};
+
+/* Deque of tile indices. The owner pushes and pops at the back, thieves take 
+from the front so that they get the tiles the owner will need last. */
+class steal_deque
+{
+private:
+    std::deque<int> _tiles;
+    std::atomic_flag _lock;
+
+    inline void lock()
+    {
+        while (_lock.test_and_set(std::memory_order_acquire)) {
+            _mm_pause();
+        }
+    };
+
+    inline void unlock()
+    {
+        _lock.clear(std::memory_order_release);
+    };
+
+public:
+    inline steal_deque() 
+    {
+        _lock.clear();
+    };
+
+    inline void push(int tile)
+    {
+        lock();
+        _tiles.push_back(tile);
+        unlock();
+    };
+
+    inline bool pop(int& tile)
+    {
+        lock();
+        bool found = !_tiles.empty();
+        if (found) {
+            tile = _tiles.back();
+            _tiles.pop_back();
+        }
+        unlock();
+        return found;
+    };
+
+    inline bool steal(int& tile)
+    {
+        lock();
+        bool found = !_tiles.empty();
+        if (found) {
+            tile = _tiles.front();
+            _tiles.pop_front();
+        }
+        unlock();
+        return found;
+    };
+};
+
+/* Splits length into parts of at least part_len, the last part takes the 
+remainder. Returns the start of every part followed by length. */
+static std::vector<int> split_tiles(int length, int part_len)
+{
+    int parts = std::max(1, length / part_len);
+    std::vector<int> starts;
+    for (int i = 0; i < parts; i++) {
+        starts.push_back(i * part_len);
+    }
+    starts.push_back(length);
+    return starts;
+}
+
+void cpu_steal_threads(char* grid, int width, int height, int gens, int threads)
+{
+    if (width < 16) {
+        cpu_omp_threads(grid, width, height, gens, threads);
+        return;
+    }
+    if (gens <= 0) {
+        return;
+    }
+
+    std::vector<int> x_starts = split_tiles(width, std::max(16, tile_width_lines * cache_line_size));
+    std::vector<int> y_starts = split_tiles(height, tile_height);
+    int tiles_x = x_starts.size() - 1;
+    int tiles_y = y_starts.size() - 1;
+    int tiles_count = tiles_x * tiles_y;
+
+    steal_tile* tiles = new steal_tile[tiles_count];
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            steal_tile& tile = tiles[ty * tiles_x + tx];
+            tile.x_start = x_starts[tx];
+            tile.x_end = x_starts[tx + 1];
+            tile.y_start = y_starts[ty];
+            tile.y_end = y_starts[ty + 1];
+            tile.gen = 0;
+            tile.ready[0].store(0, std::memory_order_relaxed);
+            tile.ready[1].store(0, std::memory_order_relaxed);
+            tile.neighbors_count = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int neighbor = ((ty + dy + tiles_y) % tiles_y) * tiles_x + (tx + dx + tiles_x) % tiles_x;
+                    int* end = tile.neighbors + tile.neighbors_count;
+                    if (std::find(tile.neighbors, end, neighbor) == end) {
+                        tile.neighbors[tile.neighbors_count++] = neighbor;
+                    }
+                }
+            }
+        }
+    }
+
+    // Every tile is ready for the first generation. Threads start with a
+    // contiguous run of tiles each for locality.
+    threads = std::min(threads, tiles_count);
+    steal_deque* deques = new steal_deque[threads];
+    for (int i = 0; i < tiles_count; i++) {
+        deques[(long)i * threads / tiles_count].push(i);
+    }
+    std::atomic<long> remaining((long)tiles_count * gens);
+
+    size_t size = (size_t)width * height;
+    char* buf = new char[size];
+
+    #pragma omp parallel num_threads(threads) default(none) \
+    shared(grid, buf, width, height, gens, threads, tiles, tiles_x, deques, remaining)
+    {
+        int tid = omp_get_thread_num();
+        int victim = tid;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            int t;
+            if (!deques[tid].pop(t)) {
+                victim = (victim + 1) % threads;
+                if (victim == tid || !deques[victim].steal(t)) {
+                    _mm_pause();
+                    continue;
+                }
+            }
+
+            // Generations alternate between grid and buf like in the other 
+            // engines, a tile only reads and writes its own generations.
+            steal_tile& tile = tiles[t];
+            char* src = tile.gen & 1 ? buf : grid;
+            char* dst = tile.gen & 1 ? grid : buf;
+            for (int y = tile.y_start; y < tile.y_end; y++) {
+                int y_north = y ? y - 1 : height - 1;
+                int y_south = y == height - 1 ? 0 : y + 1;
+                if (tiles_x == 1) {
+                    cpu_simd_row(src, dst, width, y, y_north, y_south);
+                }
+                else {
+                    cpu_simd_16_row_span(src, dst, width, y, y_north, y_south, tile.x_start, tile.x_end);
+                }
+            }
+            int gen = ++tile.gen;
+
+            // The last neighbor to finish this generation schedules the next
+            // generation of a tile. Neighbors are at most one generation 
+            // apart, so two counters are enough.
+            if (gen < gens) {
+                for (int i = 0; i < tile.neighbors_count; i++) {
+                    steal_tile& neighbor = tiles[tile.neighbors[i]];
+                    if (neighbor.ready[gen & 1].fetch_add(1, std::memory_order_acq_rel) + 1 == 
+                        neighbor.neighbors_count) {
+                        neighbor.ready[gen & 1].store(0, std::memory_order_relaxed);
+                        deques[tid].push(tile.neighbors[i]);
+                    }
+                }
+            }
+            remaining.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to grid.
+    if (gens % 2) {
+        memcpy(grid, buf, size);
+    }
+    delete[] buf;
+    delete[] deques;
+    delete[] tiles;
+}
+
+void cpu_steal(char* grid, int width, int height, int gens)
+{
+    cpu_steal_threads(grid, width, height, gens, omp_get_num_procs());
+}
@@ -0,0 +1,183 @@
+/**
+ * cpu_tiled.cpp
+ *
+ * Multi-threaded CPU SIMD on a tile-major world. Every tile is computed from
+ * itself and the edges of its eight neighbors, so a thread working on a tile
+ * only touches nine 4 KiB tiles instead of three rows the width of the world.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <cstdlib>
+#include <cstring>
+#include <omp.h>
+
+#include <cpu_simd.hpp>
+#include <cpu_tiled.hpp>
+#include <game_of_life.hpp>
+#include <util.hpp>
+
+void tiled_from_rows(const char* grid, char* tiles, int width, int height)
+{
+    int tiles_x = width / tile_dim;
+    #pragma omp parallel for default(none) shared(grid, tiles, width, height, tiles_x)
+    for (int y = 0; y < height; y++) {
+        const char* row = grid + (size_t)y * width;
+        char* tile_row = tiles + (size_t)(y / tile_dim) * tiles_x * tile_size + (y % tile_dim) * tile_dim;
+        for (int tx = 0; tx < tiles_x; tx++) {
+            memcpy(tile_row + (size_t)tx * tile_size, row + tx * tile_dim, tile_dim);
+        }
+    }
+}
+
+void tiled_to_rows(const char* tiles, char* grid, int width, int height)
+{
+    int tiles_x = width / tile_dim;
+    #pragma omp parallel for default(none) shared(grid, tiles, width, height, tiles_x)
+    for (int y = 0; y < height; y++) {
+        char* row = grid + (size_t)y * width;
+        const char* tile_row = tiles + (size_t)(y / tile_dim) * tiles_x * tile_size + (y % tile_dim) * tile_dim;
+        for (int tx = 0; tx < tiles_x; tx++) {
+            memcpy(row + tx * tile_dim, tile_row + (size_t)tx * tile_size, tile_dim);
+        }
+    }
+}
+
+#if defined __SSE2__ && defined __SSSE3__
+/* Returns the sum of the north, current and south vectors and their west and
+east neighbors, where west and east are each either loaded next to the vector
+or shifted in from the cell of the neighboring tile. */
+static inline __m128i tile_vec_count(__m128i n_cells, __m128i n_west, __m128i n_east, __m128i cells,
+    __m128i west, __m128i east, __m128i s_cells, __m128i s_west, __m128i s_east)
+{
+    __m128i neighbors_count = n_cells;
+    neighbors_count = _mm_add_epi8(neighbors_count, n_west);
+    neighbors_count = _mm_add_epi8(neighbors_count, n_east);
+    neighbors_count = _mm_add_epi8(neighbors_count, west);
+    neighbors_count = _mm_add_epi8(neighbors_count, east);
+    neighbors_count = _mm_add_epi8(neighbors_count, s_cells);
+    neighbors_count = _mm_add_epi8(neighbors_count, s_west);
+    neighbors_count = _mm_add_epi8(neighbors_count, s_east);
+    return cpu_simd_16_alive(cells, neighbors_count);
+}
+#endif
+
+/* Processes a row of a tile given its north, current and south rows, and the
+cells west and east of each of them in the neighboring tiles. */
+static inline void tile_row(char* out, const char* p_north, const char* p_row, const char* p_south,
+    char w_north, char w_row, char w_south, char e_north, char e_row, char e_south)
+{
+#if defined __SSE2__ && defined __SSSE3__
+    __m128i n_cells = _mm_load_si128((__m128i*)p_north);
+    __m128i cells = _mm_load_si128((__m128i*)p_row);
+    __m128i s_cells = _mm_load_si128((__m128i*)p_south);
+    _mm_store_si128((__m128i*)out, tile_vec_count(n_cells, shift_in_first_16(n_cells, w_north),
+        _mm_loadu_si128((__m128i*)(p_north + 1)), cells, shift_in_first_16(cells, w_row),
+        _mm_loadu_si128((__m128i*)(p_row + 1)), s_cells, shift_in_first_16(s_cells, w_south),
+        _mm_loadu_si128((__m128i*)(p_south + 1))));
+
+    for (int x = 16; x < tile_dim - 16; x += 16) {
+        _mm_store_si128((__m128i*)(out + x), cpu_simd_16_vec_middle((char*)p_north, (char*)p_row,
+            (char*)p_south, x));
+    }
+
+    int x = tile_dim - 16;
+    n_cells = _mm_load_si128((__m128i*)(p_north + x));
+    cells = _mm_load_si128((__m128i*)(p_row + x));
+    s_cells = _mm_load_si128((__m128i*)(p_south + x));
+    _mm_store_si128((__m128i*)(out + x), tile_vec_count(n_cells, _mm_loadu_si128((__m128i*)(p_north + x - 1)),
+        shift_in_last_16(n_cells, e_north), cells, _mm_loadu_si128((__m128i*)(p_row + x - 1)),
+        shift_in_last_16(cells, e_row), s_cells, _mm_loadu_si128((__m128i*)(p_south + x - 1)),
+        shift_in_last_16(s_cells, e_south)));
+#else
+    for (int x = 0; x < tile_dim; x++) {
+        int west = x ? x - 1 : -1;
+        int east = x < tile_dim - 1 ? x + 1 : -1;
+        int neighbors_count = p_north[x] + p_south[x];
+        neighbors_count += west < 0 ? w_north + w_row + w_south : p_north[west] + p_row[west] + p_south[west];
+        neighbors_count += east < 0 ? e_north + e_row + e_south : p_north[east] + p_row[east] + p_south[east];
+        out[x] = neighbors_count == 3 || (neighbors_count == 2 && p_row[x]);
+    }
+#endif
+}
+
+void tile_next(const char* const* tiles, char* out)
+{
+    const char* center = tiles[tile_c];
+    const char* west = tiles[tile_w];
+    const char* east = tiles[tile_e];
+    int last = tile_dim - 1;
+
+    for (int y = 0; y < tile_dim; y++) {
+        // Rows north of the first row and south of the last row come from the
+        // last and first rows of the north and south tiles, and likewise for
+        // the cells west and east of them.
+        const char* p_north = y ? center + (y - 1) * tile_dim : tiles[tile_n] + last * tile_dim;
+        const char* p_row = center + y * tile_dim;
+        const char* p_south = y < last ? center + (y + 1) * tile_dim : tiles[tile_s];
+        char w_north = y ? west[(y - 1) * tile_dim + last] : tiles[tile_nw][last * tile_dim + last];
+        char w_south = y < last ? west[(y + 1) * tile_dim + last] : tiles[tile_sw][last];
+        char e_north = y ? east[(y - 1) * tile_dim] : tiles[tile_ne][last * tile_dim];
+        char e_south = y < last ? east[(y + 1) * tile_dim] : tiles[tile_se][0];
+        tile_row(out + y * tile_dim, p_north, p_row, p_south, w_north, west[y * tile_dim + last], w_south,
+            e_north, east[y * tile_dim], e_south);
+    }
+}
+
+void cpu_omp_tiles(char* tiles, int width, int height, int gens)
+{
+    int tiles_x = width / tile_dim;
+    int tiles_y = height / tile_dim;
+    int tiles_count = tiles_x * tiles_y;
+    char* buf = (char*)aligned_alloc(tile_dim, (size_t)tiles_count * tile_size);
+
+    for (int i = 0; i < gens; i++) {
+        #pragma omp parallel for default(none) shared(tiles, buf, tiles_x, tiles_y, tiles_count)
+        for (int t = 0; t < tiles_count; t++) {
+            int tx = t % tiles_x;
+            int ty = t / tiles_x;
+            int tx_west = tx ? tx - 1 : tiles_x - 1;
+            int tx_east = tx < tiles_x - 1 ? tx + 1 : 0;
+            int ty_north = ty ? ty - 1 : tiles_y - 1;
+            int ty_south = ty < tiles_y - 1 ? ty + 1 : 0;
+            const char* neighbors[9] = {
+                tiles + (size_t)(ty_north * tiles_x + tx_west) * tile_size,
+                tiles + (size_t)(ty_north * tiles_x + tx) * tile_size,
+                tiles + (size_t)(ty_north * tiles_x + tx_east) * tile_size,
+                tiles + (size_t)(ty * tiles_x + tx_west) * tile_size,
+                tiles + (size_t)(ty * tiles_x + tx) * tile_size,
+                tiles + (size_t)(ty * tiles_x + tx_east) * tile_size,
+                tiles + (size_t)(ty_south * tiles_x + tx_west) * tile_size,
+                tiles + (size_t)(ty_south * tiles_x + tx) * tile_size,
+                tiles + (size_t)(ty_south * tiles_x + tx_east) * tile_size
+            };
+            tile_next(neighbors, buf + (size_t)t * tile_size);
+        }
+        swap_ptr((void**)&tiles, (void**)&buf);
+    }
+
+    // If number of generations is odd, the result is in buf, so copy to tiles.
+    if (gens % 2) {
+        memcpy(buf, tiles, (size_t)tiles_count * tile_size);
+        swap_ptr((void**)&tiles, (void**)&buf);
+    }
+    free(buf);
+}
+
+/* Game of Life CPU OpenMP on tiles
+
+Worlds with width or height that are not multiples of tile_dim are simulated
+by cpu_omp instead. */
+void cpu_omp_tiled(char* grid, int width, int height, int gens)
+{
+    if (width % tile_dim || height % tile_dim) {
+        cpu_omp(grid, width, height, gens);
+        return;
+    }
+    size_t size = (size_t)width * height;
+    char* tiles = (char*)aligned_alloc(tile_dim, size);
+    tiled_from_rows(grid, tiles, width, height);
+    cpu_omp_tiles(tiles, width, height, gens);
+    tiled_to_rows(tiles, grid, width, height);
+    free(tiles);
+}
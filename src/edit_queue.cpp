@@ -0,0 +1,99 @@
+/**
+ * edit_queue.cpp
+ *
+ * Lock-free queue of cell edits, see edit_queue.hpp.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <edit_queue.hpp>
+
+/* Frees a list of edits. */
+static void free_edits(edit_node* node)
+{
+    while (node) {
+        edit_node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+edit_batch& edit_batch::operator=(edit_batch&& other)
+{
+    if (this != &other) {
+        free_edits(_first);
+        _first = other._first;
+        other._first = nullptr;
+    }
+    return *this;
+}
+
+edit_batch::~edit_batch()
+{
+    free_edits(_first);
+}
+
+void edit_batch::apply(char* grid, int width, int height, int y_start, int y_end) const
+{
+    for (edit_node* node = _first; node; node = node->next) {
+        const cell_edit& edit = node->edit;
+        int x0 = std::max(edit.x, 0);
+        int x1 = (int)std::min((int64_t)edit.x + edit.width, (int64_t)width);
+        int y0 = std::max(edit.y, y_start);
+        int y1 = (int)std::min((int64_t)edit.y + edit.height, (int64_t)std::min(y_end, height));
+        if (x0 >= x1) {
+            continue;
+        }
+        for (int y = y0; y < y1; y++) {
+            char* row = grid + (size_t)y * width;
+            switch (edit.op) {
+                case cell_edit_set:
+                    memset(row + x0, 1, x1 - x0);
+                    break;
+                case cell_edit_clear:
+                    memset(row + x0, 0, x1 - x0);
+                    break;
+                default:
+                    for (int x = x0; x < x1; x++) {
+                        row[x] ^= 1;
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+edit_queue::~edit_queue()
+{
+    free_edits(_head.load(std::memory_order_acquire));
+}
+
+void edit_queue::push(const cell_edit& edit)
+{
+    if (edit.op != cell_edit_set && edit.op != cell_edit_clear && edit.op != cell_edit_toggle) {
+        throw std::invalid_argument("op must be a cell_edit_op");
+    }
+    edit_node* node = new edit_node{edit, _head.load(std::memory_order_relaxed)};
+    while (!_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+edit_batch edit_queue::take()
+{
+    // The stack has the newest edit first, so it is reversed into the order
+    // the edits were pushed in.
+    edit_node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    edit_node* first = nullptr;
+    while (node) {
+        edit_node* next = node->next;
+        node->next = first;
+        first = node;
+        node = next;
+    }
+    return edit_batch(first);
+}
@@ -7,24 +7,51 @@
  * Author: Carl Marquez
  * Created on: June 15, 2018
  */ 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <iostream>
 #include <memory>
+#include <omp.h>
+#include <thread>
+#include <vector>
 
+#include <change_stream.hpp>
+#include <cow_world.hpp>
+#include <cpu_dist.hpp>
+#include <cpu_ooc.hpp>
+#include <cpu_stencil.hpp>
+#include <edit_queue.hpp>
 #include <game_of_life.hpp>
+#include <sim_auto.hpp>
+#include <sim_pool.hpp>
+#include <soup_search.hpp>
+#include <trace.hpp>
 #include <util.hpp>
+#include <viewport.hpp>
 
 // Minimum dimension of 3 so every cell has 8 neighbors, max dimension of 16384
 // to not consume too much memory, can be increased if system has more.
 const int min_dim = 3;
 const int max_dim = 1048576;
 
+// Cell counts and offsets are size_t everywhere, rows and columns are int.
+static_assert((size_t)max_dim * max_dim / max_dim == (size_t)max_dim, 
+    "size_t must hold the cell count of the largest world");
+
 // For error logging
 const std::string min_dim_str = std::to_string(min_dim);
 const std::string max_dim_str = std::to_string(max_dim);
 
+// Processes and ghost rows per exchange for the distributed benchmark.
+const int dist_procs = 4;
+const int dist_halo = 4;
+
+// Buffers for the out-of-core benchmark, small enough that the larger worlds
+// are streamed through memory in several bands.
+const size_t ooc_memory = 1 << 20;
+
 /* Generates a random world. */
 char* generate_random_world(int width, int height, int percent_alive)
 {
@@ -37,11 +64,16 @@ char* generate_random_world(int width, int height, int percent_alive)
     if (height < min_dim || height > max_dim) {
         throw std::invalid_argument("height must be between " + min_dim_str + " and " + max_dim_str);
     }
-    int size = width * height;
-    char* world = (char*)aligned_alloc(64, size);
+    size_t size = (size_t)width * height;
+
+    // aligned_alloc needs a multiple of the alignment.
+    char* world = (char*)aligned_alloc(64, (size + 63) / 64 * 64);
+    if (!world) {
+        throw std::runtime_error("not enough memory for a world of " + std::to_string(size) + " cells");
+    }
 
     srand(time(nullptr));
-    for (int i = 0; i < size; i++) {
+    for (size_t i = 0; i < size; i++) {
         if (rand() % 100 < percent_alive) {
             world[i] = 1;
         }
@@ -52,6 +84,20 @@ char* generate_random_world(int width, int height, int percent_alive)
     return world;
 }
 
+// Worlds from aligned_alloc, which must be freed with free, not delete[].
+typedef std::unique_ptr<char, decltype(&free)> aligned_world_t;
+
+/* Allocates a world of size cells aligned to a cache line. */
+static aligned_world_t aligned_world(size_t size)
+{
+    // aligned_alloc needs a multiple of the alignment.
+    char* world = (char*)aligned_alloc(64, (size + 63) / 64 * 64);
+    if (!world) {
+        throw std::runtime_error("not enough memory for a world of " + std::to_string(size) + " cells");
+    }
+    return aligned_world_t(world, free);
+}
+
 /* Simulates game of life on CPU and returns the runtime in ms. */
 double run_game_of_life_cpu(cpu_sim_t func, char* world, int width, int height, int gens)
 {
@@ -61,29 +107,150 @@ double run_game_of_life_cpu(cpu_sim_t func, char* world, int width, int height,
     return timer.stop();
 }
 
+/* Applies an edit to a world cell by cell, the reference for the edit queue. */
+static void apply_edit(char* world, int width, int height, const cell_edit& edit)
+{
+    for (int y = std::max(edit.y, 0); y < std::min(edit.y + edit.height, height); y++) {
+        for (int x = std::max(edit.x, 0); x < std::min(edit.x + edit.width, width); x++) {
+            char& cell = world[(size_t)y * width + x];
+            cell = edit.op == cell_edit_set ? 1 : edit.op == cell_edit_clear ? 0 : !cell;
+        }
+    }
+}
+
+/* Returns true if cpu_omp_edit simulates a world with edits pushed at known
+generations like cpu_seq with the same edits applied by hand. */
+static bool check_edits(const char* world, int width, int height, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world_seq = aligned_world(size);
+    aligned_world_t world_edit = aligned_world(size);
+    memcpy(world_seq.get(), world, size);
+    memcpy(world_edit.get(), world, size);
+
+    // Edits of every kind, across the bands of the threads and partly outside
+    // the world. Every step pushes an edit and the one after it, which
+    // overlap, so they must be applied in order.
+    const cell_edit known_edits[] = {
+        {0, 0, width, 1, cell_edit_set},
+        {width / 2, height / 3, 5, height / 2, cell_edit_toggle},
+        {-3, height - 2, 7, 5, cell_edit_clear},
+        {width - 4, 0, 8, height, cell_edit_toggle},
+        {1, 1, 1, 1, cell_edit_set},
+        {0, height / 2, width, 2, cell_edit_toggle}
+    };
+    int edits_count = sizeof(known_edits) / sizeof(known_edits[0]);
+    int step = std::max(1, gens / edits_count);
+
+    edit_queue edits;
+    for (int i = 0, e = 0; i < gens; i += step, e++) {
+        int n = std::min(step, gens - i);
+        for (int j = e; j < e + 2; j++) {
+            edits.push(known_edits[j % edits_count]);
+            apply_edit(world_seq.get(), width, height, known_edits[j % edits_count]);
+        }
+        cpu_seq(world_seq.get(), width, height, n);
+        cpu_omp_edit(world_edit.get(), width, height, n, edits);
+    }
+    return !memcmp(world_seq.get(), world_edit.get(), size);
+}
+
 static void benchmark(int width, int height, int percent_alive, int gens)
 {
-    int size = width * height;
+    size_t size = (size_t)width * height;
 
     // Create one world for each simulator
-    std::unique_ptr<char[]> world_seq(generate_random_world(width, height, percent_alive));
+    aligned_world_t world_seq(generate_random_world(width, height, percent_alive), free);
 
-    std::unique_ptr<char[]> world_simd((char*)aligned_alloc(64, size));
+    aligned_world_t world_simd = aligned_world(size);
     memcpy(world_simd.get(), world_seq.get(), size);
 
-    std::unique_ptr<char[]> world_omp((char*)aligned_alloc(64, size));
+    aligned_world_t world_simd_rowsum = aligned_world(size);
+    memcpy(world_simd_rowsum.get(), world_seq.get(), size);
+
+    aligned_world_t world_omp = aligned_world(size);
     memcpy(world_omp.get(), world_seq.get(), size);
 
-    std::unique_ptr<char[]> world_gpu((char*)aligned_alloc(64, size));
+    aligned_world_t world_omp_rowsum = aligned_world(size);
+    memcpy(world_omp_rowsum.get(), world_seq.get(), size);
+
+    aligned_world_t world_edit = aligned_world(size);
+    memcpy(world_edit.get(), world_seq.get(), size);
+
+    aligned_world_t world_tiled = aligned_world(size);
+    memcpy(world_tiled.get(), world_seq.get(), size);
+
+    aligned_world_t world_lut = aligned_world(size);
+    memcpy(world_lut.get(), world_seq.get(), size);
+
+    aligned_world_t world_steal = aligned_world(size);
+    memcpy(world_steal.get(), world_seq.get(), size);
+
+    aligned_world_t world_gpu = aligned_world(size);
     memcpy(world_gpu.get(), world_seq.get(), size);
 
+    aligned_world_t world_bits = aligned_world(size);
+    memcpy(world_bits.get(), world_seq.get(), size);
+
+    aligned_world_t world_hybrid = aligned_world(size);
+    memcpy(world_hybrid.get(), world_seq.get(), size);
+
+    aligned_world_t world_dist = aligned_world(size);
+    memcpy(world_dist.get(), world_seq.get(), size);
+
+    aligned_world_t world_ooc = aligned_world(size);
+    memcpy(world_ooc.get(), world_seq.get(), size);
+
+    aligned_world_t world_auto = aligned_world(size);
+    memcpy(world_auto.get(), world_seq.get(), size);
+
     // Simulate every copy of the world for the same number generations on
     // different simulators. The result must be the same for all.
     double seq_time = run_game_of_life_cpu(cpu_seq, world_seq.get(), width, height, gens);
     double simd_time = run_game_of_life_cpu(cpu_simd, world_simd.get(), width, height, gens);
+    double simd_rowsum_time = run_game_of_life_cpu(cpu_simd_rowsum, world_simd_rowsum.get(), width, height, 
+        gens);
     double omp_time = run_game_of_life_cpu(cpu_omp, world_omp.get(), width, height, gens);
+    double omp_rowsum_time = run_game_of_life_cpu(cpu_omp_rowsum, world_omp_rowsum.get(), width, height, gens);
+    // Nothing is edited, so only the cost of checking for edits is measured
+    edit_queue edits;
+    my_timer edit_timer;
+    edit_timer.start();
+    cpu_omp_edit(world_edit.get(), width, height, gens, edits);
+    double edit_time = edit_timer.stop();
+    double tiled_time = run_game_of_life_cpu(cpu_omp_tiled, world_tiled.get(), width, height, gens);
+
+    // Lookup table blocks are 2x2 cells
+    bool lut = !(width % 2) && !(height % 2);
+    double lut_time = 0;
+    if (lut) {
+        lut_time = run_game_of_life_cpu(cpu_lut, world_lut.get(), width, height, gens);
+    }
+    double steal_time = run_game_of_life_cpu(cpu_steal, world_steal.get(), width, height, gens);
     double ocl_time;
     gpu_ocl(world_gpu.get(), width, height, gens, &ocl_time);
+    // Bit-packed kernels only take widths that are multiples of 32
+    bool bits = !(width % 32);
+    double bits_time = 0;
+    if (bits) {
+        gpu_ocl_packed(world_bits.get(), width, height, gens, &bits_time);
+    }
+    double hybrid_time = run_game_of_life_cpu(cpu_gpu_hybrid, world_hybrid.get(), width, height, gens);
+    my_timer dist_timer;
+    dist_timer.start();
+    cpu_dist_local(world_dist.get(), width, height, gens, dist_procs, dist_halo);
+    double dist_time = dist_timer.stop();
+    // The out-of-core file is bit-packed like the OpenCL Bits world
+    double ooc_time = 0;
+    if (bits) {
+        my_timer ooc_timer;
+        ooc_timer.start();
+        cpu_ooc(world_ooc.get(), width, height, gens, ooc_memory);
+        ooc_time = ooc_timer.stop();
+    }
+    // The profile is measured before timing if this host has none yet
+    sim_auto_choice auto_choice = sim_auto_choose(width, height, gens);
+    double auto_time = run_game_of_life_cpu(sim_auto, world_auto.get(), width, height, gens);
 
     // Print runtimes
     std::cout << "Size: " << width << " x " << height << std::endl;
@@ -93,19 +260,546 @@ static void benchmark(int width, int height, int percent_alive, int gens)
     printf("|-------------------------------|---------|\n");
     printf("| CPU Sequential | %12.2f | %6.2fx |\n", seq_time, 1.0);
     printf("| CPU SIMD 1T    | %12.2f | %6.2fx |\n", simd_time, seq_time / simd_time);
+    printf("| CPU SIMD RS 1T | %12.2f | %6.2fx |\n", simd_rowsum_time, seq_time / simd_rowsum_time);
     printf("| CPU OpenMP     | %12.2f | %6.2fx |\n", omp_time, seq_time / omp_time);
+    printf("| CPU OpenMP RS  | %12.2f | %6.2fx |\n", omp_rowsum_time, seq_time / omp_rowsum_time);
+    printf("| CPU OMP Edits  | %12.2f | %6.2fx |\n", edit_time, seq_time / edit_time);
+    printf("| CPU OMP Tiled  | %12.2f | %6.2fx |\n", tiled_time, seq_time / tiled_time);
+    if (lut) {
+        printf("| CPU LUT 2x2    | %12.2f | %6.2fx |\n", lut_time, seq_time / lut_time);
+    }
+    printf("| CPU Stealing   | %12.2f | %6.2fx |\n", steal_time, seq_time / steal_time);
     printf("| GPU OpenCL     | %12.2f | %6.2fx |\n", ocl_time, seq_time / ocl_time);
-    printf("+-----------------------------------------+\n\n");
+    if (bits) {
+        printf("| GPU OpenCL Bits| %12.2f | %6.2fx |\n", bits_time, seq_time / bits_time);
+    }
+    printf("| CPU+GPU Hybrid | %12.2f | %6.2fx |\n", hybrid_time, seq_time / hybrid_time);
+    printf("| CPU Dist 4P    | %12.2f | %6.2fx |\n", dist_time, seq_time / dist_time);
+    if (bits) {
+        printf("| CPU Out-of-core| %12.2f | %6.2fx |\n", ooc_time, seq_time / ooc_time);
+    }
+    printf("| Auto           | %12.2f | %6.2fx |\n", auto_time, seq_time / auto_time);
+    printf("+-----------------------------------------+\n");
+    printf("Auto: %s with %d threads\n\n", sim_auto_engine_name(auto_choice.engine), auto_choice.threads);
 
     if (memcmp(world_seq.get(), world_simd.get(), size)) {
         std::cerr << "CPU SIMD is not equal to the reference implementation" << std::endl;
     }
+    else if (memcmp(world_seq.get(), world_simd_rowsum.get(), size)) {
+        std::cerr << "CPU SIMD RS is not equal to the reference implementation" << std::endl;
+    }
     else if (memcmp(world_seq.get(), world_omp.get(), size)) {
         std::cerr << "CPU OpenMP is not equal to the reference implementation" << std::endl;
     }
+    else if (memcmp(world_seq.get(), world_omp_rowsum.get(), size)) {
+        std::cerr << "CPU OpenMP RS is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_edit.get(), size)) {
+        std::cerr << "CPU OMP Edits is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_tiled.get(), size)) {
+        std::cerr << "CPU OMP Tiled is not equal to the reference implementation" << std::endl;
+    }
+    else if (lut && memcmp(world_seq.get(), world_lut.get(), size)) {
+        std::cerr << "CPU LUT is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_steal.get(), size)) {
+        std::cerr << "CPU Stealing is not equal to the reference implementation" << std::endl;
+    }
     else if (memcmp(world_gpu.get(), world_omp.get(), size)) {
         std::cerr << "GPU OpenCL is not equal to the reference implementation" << std::endl;
     }
+    else if (bits && memcmp(world_seq.get(), world_bits.get(), size)) {
+        std::cerr << "GPU OpenCL Bits is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_hybrid.get(), size)) {
+        std::cerr << "CPU+GPU Hybrid is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_dist.get(), size)) {
+        std::cerr << "CPU Dist is not equal to the reference implementation" << std::endl;
+    }
+    else if (bits && memcmp(world_seq.get(), world_ooc.get(), size)) {
+        std::cerr << "CPU Out-of-core is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_auto.get(), size)) {
+        std::cerr << "Auto is not equal to the reference implementation" << std::endl;
+    }
+    if (!check_edits(world_seq.get(), width, height, gens / 20)) {
+        std::cerr << "CPU OMP Edits does not apply edits like the reference implementation" << std::endl;
+    }
+}
+
+/* Compares the barrier and overlapped OpenMP schedules across thread counts. */
+static void benchmark_omp_schedules(int width, int height, int percent_alive, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+    aligned_world_t world_barrier = aligned_world(size);
+    aligned_world_t world_overlap = aligned_world(size);
+
+    std::cout << "Size: " << width << " x " << height << std::endl;
+    std::cout << "Generations: " << gens << std::endl;
+    printf("+------------------------------------------------+\n");
+    printf("| Threads | Barrier (ms) | Overlap (ms) | Speedup |\n");
+    printf("|---------|--------------|--------------|---------|\n");
+
+    int max_threads = omp_get_num_procs();
+    for (int threads = 1; threads <= max_threads; threads = threads < max_threads ? 
+        std::min(threads * 2, max_threads) : threads + 1) {
+        memcpy(world_barrier.get(), world.get(), size);
+        memcpy(world_overlap.get(), world.get(), size);
+
+        my_timer timer;
+        timer.start();
+        cpu_omp_threads(world_barrier.get(), width, height, gens, threads);
+        double barrier_time = timer.stop();
+        timer.start();
+        cpu_omp_overlap(world_overlap.get(), width, height, gens, threads);
+        double overlap_time = timer.stop();
+
+        printf("| %7d | %12.2f | %12.2f | %6.2fx |\n", threads, barrier_time, overlap_time, 
+            barrier_time / overlap_time);
+        if (memcmp(world_barrier.get(), world_overlap.get(), size)) {
+            std::cerr << "CPU OpenMP overlap is not equal to CPU OpenMP barrier" << std::endl;
+        }
+    }
+    printf("+------------------------------------------------+\n\n");
+}
+
+/* Compares the barrier and generation-pipelined OpenMP schedules across thread
+counts, for narrow and tall worlds. */
+static void benchmark_pipeline(int width, int height, int percent_alive, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+    aligned_world_t world_barrier = aligned_world(size);
+    aligned_world_t world_pipeline = aligned_world(size);
+
+    std::cout << "Size: " << width << " x " << height << std::endl;
+    std::cout << "Generations: " << gens << std::endl;
+    printf("+-------------------------------------------------+\n");
+    printf("| Threads | Barrier (ms) | Pipeline (ms) | Speedup |\n");
+    printf("|---------|--------------|---------------|---------|\n");
+
+    int max_threads = omp_get_num_procs();
+    for (int threads = 1; threads <= max_threads; threads = threads < max_threads ? 
+        std::min(threads * 2, max_threads) : threads + 1) {
+        memcpy(world_barrier.get(), world.get(), size);
+        memcpy(world_pipeline.get(), world.get(), size);
+
+        my_timer timer;
+        timer.start();
+        cpu_omp_threads(world_barrier.get(), width, height, gens, threads);
+        double barrier_time = timer.stop();
+        timer.start();
+        cpu_omp_pipeline(world_pipeline.get(), width, height, gens, threads);
+        double pipeline_time = timer.stop();
+
+        printf("| %7d | %12.2f | %13.2f | %6.2fx |\n", threads, barrier_time, pipeline_time, 
+            barrier_time / pipeline_time);
+        if (memcmp(world_barrier.get(), world_pipeline.get(), size)) {
+            std::cerr << "CPU OpenMP pipeline is not equal to CPU OpenMP barrier" << std::endl;
+        }
+    }
+    printf("+-------------------------------------------------+\n\n");
+}
+
+/* Compares concurrent simulations that each run cpu_omp on threads of their
+own with the same simulations submitted to one shared pool. */
+static void benchmark_pool(int width, int height, int percent_alive, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+
+    std::cout << "Size: " << width << " x " << height << std::endl;
+    std::cout << "Generations: " << gens << std::endl;
+    printf("+-------------------------------------------------------------+\n");
+    printf("| Jobs | Separate (ms) | Pool (ms) | Speedup | Avg Queue (ms) |\n");
+    printf("|------|---------------|-----------|---------|----------------|\n");
+
+    sim_pool pool;
+    for (int jobs = 1; jobs <= 2 * pool.threads(); jobs *= 2) {
+        std::vector<std::unique_ptr<char[]>> worlds_separate;
+        std::vector<std::unique_ptr<char[]>> worlds_pool;
+        for (int i = 0; i < jobs; i++) {
+            worlds_separate.emplace_back(new char[size]);
+            worlds_pool.emplace_back(new char[size]);
+            memcpy(worlds_separate.back().get(), world.get(), size);
+            memcpy(worlds_pool.back().get(), world.get(), size);
+        }
+
+        my_timer timer;
+        timer.start();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < jobs; i++) {
+            threads.emplace_back(cpu_omp, worlds_separate[i].get(), width, height, gens);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double separate_time = timer.stop();
+
+        timer.start();
+        std::vector<std::future<sim_job_stats>> futures;
+        for (int i = 0; i < jobs; i++) {
+            futures.push_back(pool.submit(worlds_pool[i].get(), width, height, gens));
+        }
+        double queue_time = 0;
+        for (std::future<sim_job_stats>& future : futures) {
+            queue_time += future.get().queue_time;
+        }
+        double pool_time = timer.stop();
+
+        printf("| %4d | %13.2f | %9.2f | %6.2fx | %14.2f |\n", jobs, separate_time, pool_time, 
+            separate_time / pool_time, queue_time / jobs);
+        for (int i = 0; i < jobs; i++) {
+            if (memcmp(worlds_separate[i].get(), worlds_pool[i].get(), size)) {
+                std::cerr << "Simulation pool is not equal to CPU OpenMP" << std::endl;
+                break;
+            }
+        }
+    }
+    printf("+-------------------------------------------------------------+\n\n");
+}
+
+/* Draws the pixels of a viewport from a copy of the world. */
+static void draw_frame(const char* world, int width, const viewport& view, uint8_t* pixels)
+{
+    std::vector<uint32_t> counts((size_t)view.frame_width() * view.frame_height());
+    for (int y = 0; y < view.height; y++) {
+        viewport_add_row(view, world + (size_t)(view.y + y) * width, 
+            counts.data() + (size_t)(y / view.scale) * view.frame_width());
+    }
+    viewport_draw(view, counts.data(), pixels);
+}
+
+/* Draws a viewport into the ring from a copy of the world, the way frames are
+drawn without the viewport engines. */
+static void draw_copy(const char* world, int width, const viewport& view, viewport_ring& ring, int gen)
+{
+    draw_frame(world, width, view, ring.begin_frame());
+    ring.publish(gen);
+}
+
+/* Returns true if every frame published by an engine simulating gens 
+generations of world, as read from the ring by reader, is the frame drawn from
+a copy of the world at its generation. */
+static bool check_frames(const char* world, int width, int height, int gens, int period, const viewport& view,
+    const viewport_ring& reader)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t copy = aligned_world(size);
+    memcpy(copy.get(), world, size);
+    std::vector<uint8_t> pixels((size_t)view.frame_width() * view.frame_height());
+    for (int f = 0; (int64_t)(f + 1) * period <= gens; f++) {
+        cpu_omp(copy.get(), width, height, period);
+        draw_frame(copy.get(), width, view, pixels.data());
+        viewport_frame frame;
+        if (!reader.frame(f, frame) || frame.gen != (int64_t)(f + 1) * period || 
+            memcmp(frame.pixels, pixels.data(), pixels.size()) || !reader.valid(frame)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Compares drawing a frame every period generations from a copy of the world
+with the engines drawing it while they simulate. */
+static void benchmark_viewport(int width, int height, int percent_alive, int gens, int period)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+    aligned_world_t world_copy = aligned_world(size);
+    aligned_world_t world_view = aligned_world(size);
+    viewport view = {0, 0, width, height, 16, viewport_density};
+    viewport_ring ring("game_of_life_benchmark", view.frame_width(), view.frame_height());
+
+    std::cout << "Size: " << width << " x " << height << std::endl;
+    std::cout << "Generations: " << gens << ", frame every " << period << std::endl;
+    printf("+-------------------------------------------------------+\n");
+    printf("| Simulator      | Copy (ms)  | Viewport (ms) | Speedup |\n");
+    printf("|----------------|------------|---------------|---------|\n");
+
+    for (int gpu = 0; gpu < 2; gpu++) {
+        memcpy(world_copy.get(), world.get(), size);
+        memcpy(world_view.get(), world.get(), size);
+
+        my_timer timer;
+        timer.start();
+        for (int i = 0; i < gens; i += period) {
+            int n = std::min(period, gens - i);
+            if (gpu) {
+                gpu_ocl(world_copy.get(), width, height, n);
+            }
+            else {
+                cpu_omp(world_copy.get(), width, height, n);
+            }
+            if (n == period) {
+                draw_copy(world_copy.get(), width, view, ring, i + n);
+            }
+        }
+        double copy_time = timer.stop();
+        timer.start();
+        if (gpu) {
+            gpu_ocl_view(world_view.get(), width, height, gens, view, ring, period);
+        }
+        else {
+            cpu_omp_view(world_view.get(), width, height, gens, view, ring, period);
+        }
+        double view_time = timer.stop();
+
+        printf("| %-14s | %10.2f | %13.2f | %6.2fx |\n", gpu ? "GPU OpenCL" : "CPU OpenMP", copy_time, 
+            view_time, copy_time / view_time);
+        if (memcmp(world_copy.get(), world_view.get(), size)) {
+            std::cerr << (gpu ? "GPU OpenCL" : "CPU OpenMP") << " viewport is not equal to the copy" << std::endl;
+        }
+
+        // Every frame is read back from a ring with a slot for each, mapped
+        // read-only the way another process maps it.
+        viewport_ring frames("game_of_life_benchmark_frames", view.frame_width(), view.frame_height(), 
+            std::max(2, gens / period));
+        viewport_ring reader("game_of_life_benchmark_frames");
+        memcpy(world_view.get(), world.get(), size);
+        if (gpu) {
+            gpu_ocl_view(world_view.get(), width, height, gens, view, frames, period);
+        }
+        else {
+            cpu_omp_view(world_view.get(), width, height, gens, view, frames, period);
+        }
+        if (!check_frames(world.get(), width, height, gens, period, view, reader)) {
+            std::cerr << (gpu ? "GPU OpenCL" : "CPU OpenMP") << " viewport frames are not equal to the frames "
+                "of the copy" << std::endl;
+        }
+    }
+    printf("+-------------------------------------------------------+\n\n");
+}
+
+/* Forks a world into variants that each toggle a block of cells and simulates
+them, as full copies with cpu_omp and as copy-on-write worlds stepped
+together. */
+static void benchmark_forks(int width, int height, int percent_alive, int forks, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+    std::vector<int> edit_x(forks), edit_y(forks);
+    for (int f = 0; f < forks; f++) {
+        edit_x[f] = rand() % (width - 4);
+        edit_y[f] = rand() % (height - 4);
+    }
+
+    std::cout << "Size: " << width << " x " << height << std::endl;
+    std::cout << "Forks: " << forks << ", generations: " << gens << std::endl;
+    printf("+------------------------------------------------+\n");
+    printf("| Forks          | Time (ms)    | Memory (MiB)   |\n");
+    printf("|----------------|--------------|----------------|\n");
+
+    my_timer timer;
+    timer.start();
+    cow_world base(world.get(), width, height);
+    std::vector<cow_world> cow_forks(forks, base);
+    std::vector<cow_world*> cow_ptrs;
+    for (int f = 0; f < forks; f++) {
+        for (int y = edit_y[f]; y < edit_y[f] + 4; y++) {
+            for (int x = edit_x[f]; x < edit_x[f] + 4; x++) {
+                cow_forks[f].set_cell(x, y, !cow_forks[f].cell(x, y));
+            }
+        }
+        cow_ptrs.push_back(&cow_forks[f]);
+    }
+    cow_world::step(cow_ptrs, gens);
+    double cow_time = timer.stop();
+
+    // Every fork is a full copy kept alive for the whole run, like the 
+    // copy-on-write forks. Buffers of the next generation are not counted for
+    // either.
+    timer.start();
+    std::vector<aligned_world_t> copies;
+    for (int f = 0; f < forks; f++) {
+        copies.push_back(aligned_world(size));
+        char* copy = copies.back().get();
+        memcpy(copy, world.get(), size);
+        for (int y = edit_y[f]; y < edit_y[f] + 4; y++) {
+            for (int x = edit_x[f]; x < edit_x[f] + 4; x++) {
+                copy[(size_t)y * width + x] ^= 1;
+            }
+        }
+    }
+    for (int f = 0; f < forks; f++) {
+        cpu_omp(copies[f].get(), width, height, gens);
+    }
+    double copy_time = timer.stop();
+    printf("| %-14s | %12.2f | %14.2f |\n", "Copies", copy_time, (double)forks * size / 1048576);
+
+    std::unique_ptr<char[]> result(new char[size]);
+    for (int f = 0; f < forks; f++) {
+        cow_forks[f].to_rows(result.get());
+        if (memcmp(result.get(), copies[f].get(), size)) {
+            std::cerr << "Copy-on-write fork " << f << " is not equal to its copy" << std::endl;
+            break;
+        }
+    }
+
+    std::vector<const cow_world*> cow_const(cow_ptrs.begin(), cow_ptrs.end());
+    printf("| %-14s | %12.2f | %14.2f |\n", "Copy-on-write", cow_time, 
+        (double)cow_world::distinct_tiles(cow_const) * tile_size / 1048576);
+    printf("+------------------------------------------------+\n\n");
+}
+
+/* Returns true if two change streams have the same entries in every
+generation. */
+static bool same_changes(const change_stream& a, const change_stream& b)
+{
+    if (a.generations() != b.generations()) {
+        return false;
+    }
+    for (size_t gen = 0; gen < a.generations(); gen++) {
+        if (a.size(gen) != b.size(gen) || !std::equal(a.begin(gen), a.end(gen), b.begin(gen))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Compares the output of every generation as full frames with the change
+streams of the CPU and GPU engines. Replaying a stream on the first world must
+give the last. */
+static void benchmark_changes(int width, int height, int percent_alive, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+    aligned_world_t world_omp = aligned_world(size);
+    aligned_world_t world_changes = aligned_world(size);
+    aligned_world_t world_gpu = aligned_world(size);
+    memcpy(world_omp.get(), world.get(), size);
+    memcpy(world_changes.get(), world.get(), size);
+    memcpy(world_gpu.get(), world.get(), size);
+
+    // Full frames are every generation copied out of the world, as a consumer
+    // of frames would get them.
+    aligned_world_t frame = aligned_world(size);
+    my_timer timer;
+    timer.start();
+    for (int i = 0; i < gens; i++) {
+        cpu_omp(world_omp.get(), width, height, 1);
+        memcpy(frame.get(), world_omp.get(), size);
+    }
+    double omp_time = timer.stop();
+    change_stream cpu_changes;
+    timer.start();
+    cpu_omp_changes(world_changes.get(), width, height, gens, cpu_changes);
+    double changes_time = timer.stop();
+    change_stream gpu_changes;
+    timer.start();
+    gpu_ocl_changes(world_gpu.get(), width, height, gens, gpu_changes);
+    double gpu_time = timer.stop();
+
+    std::cout << "Size: " << width << " x " << height << ", " << percent_alive << "% alive" << std::endl;
+    std::cout << "Generations: " << gens << std::endl;
+    printf("+------------------------------------------------+\n");
+    printf("| Output         | Time (ms)    | Output (MiB)   |\n");
+    printf("|----------------|--------------|----------------|\n");
+    printf("| %-14s | %12.2f | %14.2f |\n", "Full frames", omp_time, (double)gens * size / 1048576);
+    printf("| %-14s | %12.2f | %14.2f |\n", "CPU changes", changes_time, (double)cpu_changes.bytes() / 1048576);
+    printf("| %-14s | %12.2f | %14.2f |\n", "GPU changes", gpu_time, (double)gpu_changes.bytes() / 1048576);
+    printf("+------------------------------------------------+\n\n");
+
+    for (int i = 0; i < gens; i++) {
+        cpu_changes.apply(world.get(), i);
+    }
+    if (memcmp(world.get(), world_omp.get(), size) || memcmp(world_changes.get(), world_omp.get(), size)) {
+        std::cerr << "CPU change stream is not equal to CPU OpenMP" << std::endl;
+    }
+    else if (memcmp(world_gpu.get(), world_omp.get(), size) || !same_changes(gpu_changes, cpu_changes)) {
+        std::cerr << "GPU change stream is not equal to CPU OpenMP" << std::endl;
+    }
+}
+
+/* Simulates a copy of world with stencil S on the CPU and the GPU and prints a
+row of the stencils table. Both must be equal to the sequential stencil
+kernel. */
+template <int S>
+static void benchmark_stencil(const char* name, const char* world, int width, int height, int gens)
+{
+    size_t size = (size_t)width * height;
+    aligned_world_t world_seq = aligned_world(size);
+    aligned_world_t world_omp = aligned_world(size);
+    aligned_world_t world_gpu = aligned_world(size);
+    memcpy(world_seq.get(), world, size);
+    memcpy(world_omp.get(), world, size);
+    memcpy(world_gpu.get(), world, size);
+
+    cpu_stencil_seq<S>(world_seq.get(), width, height, gens);
+    my_timer timer;
+    timer.start();
+    cpu_omp_stencil<S>(world_omp.get(), width, height, gens);
+    double omp_time = timer.stop();
+    double ocl_time;
+    gpu_ocl_stencil(world_gpu.get(), width, height, gens, S, &ocl_time);
+
+    printf("| %-14s | %9d | %12.2f | %12.2f |\n", name, __builtin_popcount(S), omp_time, ocl_time);
+    if (memcmp(world_seq.get(), world_omp.get(), size)) {
+        std::cerr << "CPU OpenMP " << name << " is not equal to the reference implementation" << std::endl;
+    }
+    else if (memcmp(world_seq.get(), world_gpu.get(), size)) {
+        std::cerr << "GPU OpenCL " << name << " is not equal to the reference implementation" << std::endl;
+    }
+}
+
+/* Compares neighborhood stencils, fewer neighbors are fewer loads and adds. */
+static void benchmark_stencils(int width, int height, int percent_alive, int gens)
+{
+    aligned_world_t world(generate_random_world(width, height, percent_alive), free);
+
+    std::cout << "Size: " << width << " x " << height << std::endl;
+    std::cout << "Generations: " << gens << std::endl;
+    printf("+----------------------------------------------------------+\n");
+    printf("| Stencil        | Neighbors | CPU OMP (ms) | GPU OCL (ms) |\n");
+    printf("|----------------|-----------|--------------|--------------|\n");
+    benchmark_stencil<stencil_moore>("Moore", world.get(), width, height, gens);
+    benchmark_stencil<stencil_hex>("Hexagonal", world.get(), width, height, gens);
+    benchmark_stencil<stencil_von_neumann>("von Neumann", world.get(), width, height, gens);
+    benchmark_stencil<stencil_nw | stencil_ne | stencil_sw | stencil_se>("Diagonal", world.get(), width, height, 
+        gens);
+    printf("+----------------------------------------------------------+\n\n");
+}
+
+/* Searches the same soups on 1 thread up to one per processor, then shows the
+most common objects. */
+static void benchmark_soups(uint64_t seed, uint64_t soups)
+{
+    std::cout << "Soups: " << soups << " of seed " << seed << std::endl;
+    printf("+------------------------------------------+\n");
+    printf("| Threads | Time (ms) | Soups/s  | Speedup |\n");
+    printf("|---------|-----------|----------|---------|\n");
+
+    soup_census first;
+    int max_threads = omp_get_num_procs();
+    for (int threads = 1; threads <= max_threads; threads = threads < max_threads ? 
+        std::min(threads * 2, max_threads) : threads + 1) {
+        soup_census census = soup_search(seed, 0, soups, threads);
+        if (threads == 1) {
+            first = census;
+        }
+        printf("| %7d | %9.2f | %8.0f | %6.2fx |\n", threads, census.seconds * 1000, census.soups_per_second(), 
+            first.seconds / census.seconds);
+        if (census.objects != first.objects || census.unsettled != first.unsettled) {
+            std::cerr << "Soup search on " << threads << " threads is not equal to 1 thread" << std::endl;
+        }
+    }
+    printf("+------------------------------------------+\n");
+
+    std::vector<std::pair<uint64_t, std::string>> by_count;
+    for (const auto& object : first.objects) {
+        by_count.push_back(std::make_pair(object.second, object.first));
+    }
+    std::sort(by_count.rbegin(), by_count.rend());
+    printf("| Object                     | Count      |\n");
+    printf("|----------------------------|------------|\n");
+    for (size_t i = 0; i < by_count.size() && i < 10; i++) {
+        printf("| %-26s | %10llu |\n", by_count[i].second.c_str(), (unsigned long long)by_count[i].first);
+    }
+    printf("| %-26s | %10llu |\n", "(unsettled soups)", (unsigned long long)first.unsettled);
+    printf("+------------------------------------------+\n\n");
 }
 
 int main(int argc, char** argv)
@@ -118,5 +812,16 @@ int main(int argc, char** argv)
     benchmark(1024, 1024, 50, gens);
     benchmark(2048, 1024, 50, gens);
     benchmark(2048, 2048, 50, gens);
+    benchmark_omp_schedules(1024, 1024, 50, gens);
+    benchmark_omp_schedules(2048, 2048, 50, gens);
+    benchmark_pipeline(4, 1048576, 50, gens / 10);
+    benchmark_pipeline(8, 524288, 50, gens / 10);
+    benchmark_pool(512, 512, 50, gens);
+    benchmark_viewport(2048, 2048, 50, gens / 10, 10);
+    benchmark_forks(2048, 2048, 50, 16, gens / 20);
+    benchmark_stencils(2048, 2048, 50, gens / 10);
+    benchmark_changes(2048, 2048, 5, gens / 10);
+    benchmark_soups(1, 10000);
+    GOL_TRACE_WRITE();
     return 0;
 }
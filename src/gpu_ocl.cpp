@@ -8,26 +8,146 @@
  */
 #include <algorithm>
 #include <CL/cl.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
 
+#include <change_stream.hpp>
+#include <cpu_stencil.hpp>
 #include <game_of_life.hpp>
 #include <gpu_ocl.hpp>
+#include <trace.hpp>
 #include <util.hpp>
+#include <viewport.hpp>
 
-gpu_ocl_compiler compiler;
-const int compute_units = compiler.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
-const int max_local_size = compiler.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
 const int processors_per_cu = 64; // AMD GCN
-const int processors_total = processors_per_cu * compute_units;
 const int workgroups_per_cu = 2; // Arbitrary limit
-const int workgroups_total = workgroups_per_cu * compute_units;
+
+/* Returns the compiler for the default device, created on first use so that
+processes that never use OpenCL never look for a device or compile. */
+static gpu_ocl_compiler& default_compiler()
+{
+    static gpu_ocl_compiler compiler;
+    return compiler;
+}
+
+/* Returns the compiler for the default device with a custom stencil built in
+as kernel_stencil_custom, one per stencil, created on first use. */
+static gpu_ocl_compiler& stencil_compiler(int stencil)
+{
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<gpu_ocl_compiler>> compilers;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<gpu_ocl_compiler>& compiler = compilers[stencil];
+    if (!compiler) {
+        compiler.reset(new gpu_ocl_compiler(default_compiler().device, 
+            "-D STENCIL_CUSTOM=" + std::to_string(stencil)));
+    }
+    return *compiler;
+}
+
+std::string& gpu_ocl_source_dir()
+{
+    static std::string dir = [] {
+        char* program_name_copy = strdup(program_invocation_name);
+        std::string program_dir = dirname(program_name_copy);
+        free(program_name_copy);
+        return program_dir;
+    }();
+    return dir;
+}
+
+/* Hashes data into hash with 64-bit FNV-1a. */
+static uint64_t fnv1a(uint64_t hash, const std::string& data)
+{
+    for (unsigned char c : data) {
+        hash = (hash ^ c) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+std::string gpu_ocl_cache_path(const cl::Device& device, const std::string& source, const std::string& options)
+{
+    std::string dir = cache_dir();
+    if (dir.empty()) {
+        return "";
+    }
+
+    // Every field ends with a zero byte so that fields cannot run into each
+    // other.
+    const std::string fields[] = { device.getInfo<CL_DEVICE_NAME>(), device.getInfo<CL_DEVICE_VENDOR>(), 
+        device.getInfo<CL_DEVICE_VERSION>(), device.getInfo<CL_DRIVER_VERSION>(), source, options };
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const std::string& field : fields) {
+        hash = fnv1a(hash, field);
+        hash = fnv1a(hash, std::string(1, '\0'));
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return dir + "/" + name;
+}
+
+bool gpu_ocl_cache_load(const std::string& path, std::string& binary)
+{
+    if (path.empty()) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    binary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !binary.empty();
+}
+
+void gpu_ocl_cache_store(const std::string& path, const cl::Program& program)
+{
+    if (path.empty()) {
+        return;
+    }
+    size_t binary_size = 0;
+    if (clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES, sizeof(binary_size), &binary_size, nullptr) || 
+        !binary_size) {
+        return;
+    }
+    std::string binary(binary_size, '\0');
+    unsigned char* binary_ptr = (unsigned char*)&binary[0];
+    if (clGetProgramInfo(program(), CL_PROGRAM_BINARIES, sizeof(binary_ptr), &binary_ptr, nullptr)) {
+        return;
+    }
+
+    // Writes to a file of this process first so that other processes never
+    // read a partial binary.
+    std::string temp_path = path + "." + std::to_string(getpid());
+    {
+        std::ofstream file(temp_path, std::ios::binary);
+        if (!file.write(binary.data(), binary.size())) {
+            file.close();
+            unlink(temp_path.c_str());
+            return;
+        }
+    }
+    if (rename(temp_path.c_str(), path.c_str())) {
+        unlink(temp_path.c_str());
+    }
+}
 
 /* Returns kernel function name, global dimensions, and local dimensions for
-given world size. */
-void get_kernel_launch_params(int width, int height, std::string& kernel_func, int& global_width, int& global_height,
-    int& local_width, int& local_height)
+given world size on the compiler's device. */
+void get_kernel_launch_params(const gpu_ocl_compiler& ocl, int width, int height, std::string& kernel_func, 
+    int& global_width, int& global_height, int& local_width, int& local_height)
 {
-    int size = width * height;
+    size_t size = (size_t)width * height;
+    int compute_units = ocl.compute_units;
+    int max_local_size = ocl.max_local_size;
+    int processors_total = processors_per_cu * compute_units;
+    int workgroups_total = workgroups_per_cu * compute_units;
 
     if (width == 16 || width == 8 || width == 4) {
         global_width = 1;
@@ -92,26 +212,45 @@ void get_kernel_launch_params(int width, int height, std::string& kernel_func, i
     }
 }
 
-void gpu_ocl(char* grid, int width, int height, int gens, double* compute_time, double* transfer_in_time,
-    double* transfer_out_time)
+bool gpu_ocl_supports_width(int width)
 {
-    cl::Kernel kernel;
-    my_timer timer;
+    return width == 16 || width == 8 || width == 4 || (width > 16 && is_power_of_2(width));
+}
 
-    // Device memory
-    int size = width * height;
-    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, size);
-    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, size);
+/* Returns a new event at the end of events, nullptr if events is nullptr. */
+static inline cl::Event* next_event(std::vector<cl::Event>* events)
+{
+    if (!events) {
+        return nullptr;
+    }
+    events->emplace_back();
+    return &events->back();
+}
 
-    // Transfer in
-    timer.start();
-    compiler.queue.enqueueWriteBuffer(grid_d, CL_TRUE, 0, size, grid);
-    compiler.queue.finish();
-    if (transfer_in_time) {
-        *transfer_in_time = timer.stop();
+#ifdef GOL_TRACE
+/* Records kernels that have completed on the trace track of the device. The 
+device clock is moved to the host clock by the host time just before the first
+kernel was queued. */
+static void gpu_ocl_trace_kernels(const gpu_ocl_compiler& ocl, const std::vector<cl::Event>& events, 
+    uint64_t enqueue_time)
+{
+    if (events.empty()) {
+        return;
     }
-    timer.stop();
+    std::string device_name = ocl.device.getInfo<CL_DEVICE_NAME>();
+    int track = trace_track("OpenCL " + device_name);
+    cl_ulong queued = events[0].getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+    for (size_t i = 0; i < events.size(); i++) {
+        cl_ulong start = events[i].getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        cl_ulong end = events[i].getProfilingInfo<CL_PROFILING_COMMAND_END>();
+        trace_record(track, "kernel", i, enqueue_time + (start - queued), enqueue_time + (end - queued));
+    }
+}
+#endif
 
+void gpu_ocl_enqueue(gpu_ocl_compiler& ocl, cl::Buffer& grid_d, cl::Buffer& buf_d, int width, int height, 
+    int gens, std::vector<cl::Event>* events)
+{
     // Kernel function name, global and work group sizes
     std::string kernel_func;
     int global_width = 0;
@@ -120,39 +259,83 @@ void gpu_ocl(char* grid, int width, int height, int gens, double* compute_time,
     int local_height = 0;
 
     // Global and workgroup sizes
-    get_kernel_launch_params(width, height, kernel_func, global_width, global_height, local_width, local_height);
-    kernel = cl::Kernel(compiler.program, kernel_func.c_str());
+    get_kernel_launch_params(ocl, width, height, kernel_func, global_width, global_height, local_width, 
+        local_height);
+    cl::Kernel kernel(ocl.program, kernel_func.c_str());
     cl::NDRange global_size(global_width, global_height);
     cl::NDRange local_size(local_width, local_height);
 
-    std::cout << global_width << " " << global_height << " " << local_width << " " << local_height << std::endl;
-
     kernel.setArg<int>(2, width);
     kernel.setArg<int>(3, height);
 
     // Launch kernel for every generation
-    timer.start();
     for (int i = 0; i < gens / 2; ++i) {
         kernel.setArg<cl::Buffer>(0, grid_d);
         kernel.setArg<cl::Buffer>(1, buf_d);
-        compiler.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size);
+        ocl.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size, nullptr, 
+            next_event(events));
         kernel.setArg<cl::Buffer>(0, buf_d);
         kernel.setArg<cl::Buffer>(1, grid_d);
-        compiler.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size);
+        ocl.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size, nullptr, 
+            next_event(events));
     }
     if (gens & 1) {
         kernel.setArg<cl::Buffer>(0, grid_d);
         kernel.setArg<cl::Buffer>(1, buf_d);
-        compiler.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size);
+        ocl.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size, nullptr, 
+            next_event(events));
+    }
+}
+
+void gpu_ocl(char* grid, int width, int height, int gens, double* compute_time, double* transfer_in_time,
+    double* transfer_out_time)
+{
+    gpu_ocl_compiler& compiler = default_compiler();
+    my_timer timer;
+
+    // Device memory
+    size_t size = (size_t)width * height;
+    gpu_ocl_check_alloc(compiler, size);
+    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, size);
+
+    // Transfer in
+    timer.start();
+    GOL_TRACE_BEGIN("transfer in", -1);
+    compiler.queue.enqueueWriteBuffer(grid_d, CL_TRUE, 0, size, grid);
+    compiler.queue.finish();
+    GOL_TRACE_END();
+    if (transfer_in_time) {
+        *transfer_in_time = timer.stop();
     }
+    timer.stop();
+
+    // Launch kernel for every generation. When tracing, the events of the
+    // kernels are kept to record when they ran on the device.
+    timer.start();
+    std::vector<cl::Event>* kernel_events = nullptr;
+#ifdef GOL_TRACE
+    std::vector<cl::Event> traced_events;
+    kernel_events = &traced_events;
+    uint64_t enqueue_time = trace_now();
+#endif
+    GOL_TRACE_BEGIN("enqueue", -1);
+    gpu_ocl_enqueue(compiler, grid_d, buf_d, width, height, gens, kernel_events);
+    GOL_TRACE_END();
+    GOL_TRACE_BEGIN("finish", -1);
     compiler.queue.finish();
+    GOL_TRACE_END();
     if (compute_time) {
         *compute_time = timer.stop();
     }
     timer.stop();
+#ifdef GOL_TRACE
+    gpu_ocl_trace_kernels(compiler, traced_events, enqueue_time);
+#endif
 
     // Transfer out
     timer.start();
+    GOL_TRACE_BEGIN("transfer out", -1);
     if (gens & 1) {
         compiler.queue.enqueueReadBuffer(buf_d, CL_TRUE, 0, size, grid);
     }
@@ -160,8 +343,303 @@ void gpu_ocl(char* grid, int width, int height, int gens, double* compute_time,
         compiler.queue.enqueueReadBuffer(grid_d, CL_TRUE, 0, size, grid);
     }
     compiler.queue.finish();
+    GOL_TRACE_END();
     if (transfer_out_time) {
         *transfer_out_time = timer.stop();
     }
     timer.stop();
 }
+
+/* Enqueues gens generations of the bit-packed kernels. The result is in 
+grid_d if gens is even, buf_d otherwise. */
+static void gpu_ocl_enqueue_packed(gpu_ocl_compiler& ocl, cl::Buffer& grid_d, cl::Buffer& buf_d, int words, 
+    int height, int gens)
+{
+    // Four words per work item if rows divide into them. Rows are spread over
+    // enough work items to fill every processor, the rest are strided.
+    int vecs = words % 4 ? words : words / 4;
+    cl::Kernel kernel(ocl.program, words % 4 ? "kernel_packed" : "kernel_packed_4");
+    int processors_total = processors_per_cu * ocl.compute_units;
+    int global_width = std::min(vecs, ocl.max_local_size);
+    int global_height = std::min(height, std::max(1, processors_total * workgroups_per_cu / global_width));
+    cl::NDRange global_size(global_width, global_height);
+
+    kernel.setArg<int>(2, words);
+    kernel.setArg<int>(3, height);
+    for (int i = 0; i < gens; ++i) {
+        kernel.setArg<cl::Buffer>(0, i & 1 ? buf_d : grid_d);
+        kernel.setArg<cl::Buffer>(1, i & 1 ? grid_d : buf_d);
+        ocl.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, cl::NullRange);
+    }
+}
+
+void gpu_ocl_bits(uint32_t* bits, int width, int height, int gens, double* compute_time, 
+    double* transfer_in_time, double* transfer_out_time)
+{
+    if (width % 32) {
+        throw std::invalid_argument("width must be a multiple of 32");
+    }
+    gpu_ocl_compiler& compiler = default_compiler();
+    my_timer timer;
+
+    // Device memory
+    int words = width / 32;
+    size_t size = (size_t)words * height * sizeof(uint32_t);
+    gpu_ocl_check_alloc(compiler, size);
+    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, size);
+
+    // Transfer in
+    timer.start();
+    compiler.queue.enqueueWriteBuffer(grid_d, CL_TRUE, 0, size, bits);
+    compiler.queue.finish();
+    if (transfer_in_time) {
+        *transfer_in_time = timer.stop();
+    }
+    timer.stop();
+
+    // Launch kernel for every generation
+    timer.start();
+    gpu_ocl_enqueue_packed(compiler, grid_d, buf_d, words, height, gens);
+    compiler.queue.finish();
+    if (compute_time) {
+        *compute_time = timer.stop();
+    }
+    timer.stop();
+
+    // Transfer out
+    timer.start();
+    compiler.queue.enqueueReadBuffer(gens & 1 ? buf_d : grid_d, CL_TRUE, 0, size, bits);
+    compiler.queue.finish();
+    if (transfer_out_time) {
+        *transfer_out_time = timer.stop();
+    }
+    timer.stop();
+}
+
+void gpu_ocl_packed(char* grid, int width, int height, int gens, double* compute_time, 
+    double* transfer_in_time, double* transfer_out_time)
+{
+    if (width % 32) {
+        throw std::invalid_argument("width must be a multiple of 32");
+    }
+    gpu_ocl_compiler& compiler = default_compiler();
+    my_timer timer;
+
+    // Device memory, the cells are only kept one per byte for the transfers.
+    size_t size = (size_t)width * height;
+    size_t words = size / 32;
+    gpu_ocl_check_alloc(compiler, size);
+    size_t processors_total = processors_per_cu * compiler.compute_units;
+    cl::NDRange convert_size(std::min(words, processors_total * workgroups_per_cu));
+    cl::Buffer cells_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, words * sizeof(uint32_t));
+    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, words * sizeof(uint32_t));
+
+    // Transfer in and pack
+    timer.start();
+    compiler.queue.enqueueWriteBuffer(cells_d, CL_TRUE, 0, size, grid);
+    cl::Kernel pack(compiler.program, "kernel_pack");
+    pack.setArg<cl::Buffer>(0, cells_d);
+    pack.setArg<cl::Buffer>(1, grid_d);
+    pack.setArg<cl_long>(2, words);
+    compiler.queue.enqueueNDRangeKernel(pack, cl::NullRange, convert_size, cl::NullRange);
+    compiler.queue.finish();
+    if (transfer_in_time) {
+        *transfer_in_time = timer.stop();
+    }
+    timer.stop();
+
+    // Launch kernel for every generation
+    timer.start();
+    gpu_ocl_enqueue_packed(compiler, grid_d, buf_d, width / 32, height, gens);
+    compiler.queue.finish();
+    if (compute_time) {
+        *compute_time = timer.stop();
+    }
+    timer.stop();
+
+    // Unpack and transfer out
+    timer.start();
+    cl::Kernel unpack(compiler.program, "kernel_unpack");
+    unpack.setArg<cl::Buffer>(0, gens & 1 ? buf_d : grid_d);
+    unpack.setArg<cl::Buffer>(1, cells_d);
+    unpack.setArg<cl_long>(2, words);
+    compiler.queue.enqueueNDRangeKernel(unpack, cl::NullRange, convert_size, cl::NullRange);
+    compiler.queue.enqueueReadBuffer(cells_d, CL_TRUE, 0, size, grid);
+    compiler.queue.finish();
+    if (transfer_out_time) {
+        *transfer_out_time = timer.stop();
+    }
+    timer.stop();
+}
+
+void gpu_ocl_stencil(char* grid, int width, int height, int gens, int stencil, double* compute_time)
+{
+    if (width <= 16 || !is_power_of_2(width)) {
+        throw std::invalid_argument("width must be a power of 2 greater than 16");
+    }
+    if (stencil < 0 || stencil > stencil_moore) {
+        throw std::invalid_argument("stencil must be a mask of the 8 neighbors of a cell");
+    }
+
+    // Stencils with a name are in every program, any other stencil is built
+    // into a program of its own.
+    const char* kernel_func = stencil == stencil_moore ? "kernel_stencil_moore" : 
+        stencil == stencil_von_neumann ? "kernel_stencil_von_neumann" : 
+        stencil == stencil_hex ? "kernel_stencil_hex" : nullptr;
+    gpu_ocl_compiler& compiler = kernel_func ? default_compiler() : stencil_compiler(stencil);
+    my_timer timer;
+
+    // Device memory
+    size_t size = (size_t)width * height;
+    gpu_ocl_check_alloc(compiler, size);
+    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, size);
+    compiler.queue.enqueueWriteBuffer(grid_d, CL_TRUE, 0, size, grid);
+
+    // Stencil kernels are laid out like kernel_width_gt16_pow2.
+    std::string gt16_func;
+    int global_width = 0;
+    int global_height = 0;
+    int local_width = 0;
+    int local_height = 0;
+    get_kernel_launch_params(compiler, width, height, gt16_func, global_width, global_height, local_width, 
+        local_height);
+    cl::Kernel kernel(compiler.program, kernel_func ? kernel_func : "kernel_stencil_custom");
+    cl::NDRange global_size(global_width, global_height);
+    cl::NDRange local_size(local_width, local_height);
+    kernel.setArg<int>(2, width);
+    kernel.setArg<int>(3, height);
+
+    // Launch kernel for every generation
+    timer.start();
+    for (int i = 0; i < gens; ++i) {
+        kernel.setArg<cl::Buffer>(0, i & 1 ? buf_d : grid_d);
+        kernel.setArg<cl::Buffer>(1, i & 1 ? grid_d : buf_d);
+        compiler.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size);
+    }
+    compiler.queue.finish();
+    if (compute_time) {
+        *compute_time = timer.stop();
+    }
+    timer.stop();
+
+    compiler.queue.enqueueReadBuffer(gens & 1 ? buf_d : grid_d, CL_TRUE, 0, size, grid);
+}
+
+void gpu_ocl_changes(char* grid, int width, int height, int gens, change_stream& changes)
+{
+    if (width <= 16 || !is_power_of_2(width)) {
+        throw std::invalid_argument("width must be a power of 2 greater than 16");
+    }
+    gpu_ocl_compiler& compiler = default_compiler();
+
+    // Device memory, room for an entry for every 16 cells.
+    size_t size = (size_t)width * height;
+    size_t max_entries = size / 16;
+    gpu_ocl_check_alloc(compiler, std::max(size, max_entries * sizeof(cl_ulong)));
+    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer changes_d(compiler.context, CL_MEM_WRITE_ONLY, max_entries * sizeof(cl_ulong));
+    cl::Buffer count_d(compiler.context, CL_MEM_READ_WRITE, sizeof(cl_uint));
+    compiler.queue.enqueueWriteBuffer(grid_d, CL_TRUE, 0, size, grid);
+
+    // Same launch as kernel_width_gt16_pow2.
+    std::string gt16_func;
+    int global_width = 0;
+    int global_height = 0;
+    int local_width = 0;
+    int local_height = 0;
+    get_kernel_launch_params(compiler, width, height, gt16_func, global_width, global_height, local_width, 
+        local_height);
+    cl::Kernel kernel(compiler.program, "kernel_width_gt16_pow2_changes");
+    cl::NDRange global_size(global_width, global_height);
+    cl::NDRange local_size(local_width, local_height);
+    kernel.setArg<int>(2, width);
+    kernel.setArg<int>(3, height);
+    kernel.setArg<cl::Buffer>(4, changes_d);
+    kernel.setArg<cl::Buffer>(5, count_d);
+
+    // Only the count and the entries of every generation are read back. Work
+    // items append in any order, so the entries are sorted by cell.
+    const cl_uint zero = 0;
+    for (int i = 0; i < gens; ++i) {
+        compiler.queue.enqueueWriteBuffer(count_d, CL_FALSE, 0, sizeof(zero), &zero);
+        kernel.setArg<cl::Buffer>(0, i & 1 ? buf_d : grid_d);
+        kernel.setArg<cl::Buffer>(1, i & 1 ? grid_d : buf_d);
+        compiler.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_size, local_size);
+        cl_uint count = 0;
+        compiler.queue.enqueueReadBuffer(count_d, CL_TRUE, 0, sizeof(count), &count);
+        uint64_t* entries = changes.append(count);
+        if (count) {
+            compiler.queue.enqueueReadBuffer(changes_d, CL_TRUE, 0, count * sizeof(cl_ulong), entries);
+            std::sort(entries, entries + count);
+        }
+    }
+
+    compiler.queue.enqueueReadBuffer(gens & 1 ? buf_d : grid_d, CL_TRUE, 0, size, grid);
+}
+
+void gpu_ocl_view(char* grid, int width, int height, int gens, const viewport& view, viewport_ring& ring,
+    int period)
+{
+    viewport_check(view, width, height);
+    if (period < 1) {
+        throw std::invalid_argument("period must be at least 1");
+    }
+    if (ring.frame_width() != view.frame_width() || ring.frame_height() != view.frame_height()) {
+        throw std::invalid_argument("ring frames must be the size of the viewport frames");
+    }
+    gpu_ocl_compiler& compiler = default_compiler();
+
+    // Device memory
+    size_t size = (size_t)width * height;
+    size_t pixels = (size_t)view.frame_width() * view.frame_height();
+    gpu_ocl_check_alloc(compiler, size);
+    cl::Buffer grid_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer buf_d(compiler.context, CL_MEM_READ_WRITE, size);
+    cl::Buffer frame_d(compiler.context, CL_MEM_WRITE_ONLY, pixels);
+
+    cl::Kernel reduce(compiler.program, "kernel_viewport");
+    reduce.setArg<cl::Buffer>(1, frame_d);
+    reduce.setArg<int>(2, width);
+    reduce.setArg<int>(3, view.x);
+    reduce.setArg<int>(4, view.y);
+    reduce.setArg<int>(5, view.scale);
+    reduce.setArg<int>(6, view.mode == viewport_max);
+    cl::NDRange frame_size(view.frame_width(), view.frame_height());
+
+    compiler.queue.enqueueWriteBuffer(grid_d, CL_TRUE, 0, size, grid);
+
+    // Every frame is reduced after period generations and read while the
+    // next period generations run. It is published once the read is done.
+    cl::Event frame_read;
+    int64_t frame_gen = -1;
+    for (int i = 0; i < gens; i += period) {
+        int n = std::min(period, gens - i);
+        gpu_ocl_enqueue(compiler, grid_d, buf_d, width, height, n);
+        if (n & 1) {
+            std::swap(grid_d, buf_d);
+        }
+        if (frame_gen >= 0) {
+            frame_read.wait();
+            ring.publish(frame_gen);
+            frame_gen = -1;
+        }
+        if (n == period) {
+            reduce.setArg<cl::Buffer>(0, grid_d);
+            compiler.queue.enqueueNDRangeKernel(reduce, cl::NullRange, frame_size, cl::NullRange);
+            compiler.queue.enqueueReadBuffer(frame_d, CL_FALSE, 0, pixels, ring.begin_frame(), nullptr, 
+                &frame_read);
+            compiler.queue.flush();
+            frame_gen = i + n;
+        }
+    }
+    if (frame_gen >= 0) {
+        frame_read.wait();
+        ring.publish(frame_gen);
+    }
+
+    compiler.queue.enqueueReadBuffer(grid_d, CL_TRUE, 0, size, grid);
+}
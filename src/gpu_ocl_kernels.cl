@@ -144,9 +144,9 @@ kernel void kernel_width_gt16_pow2(global char* grid, global char* buf, int widt
     for (int y = y_start; y < height; y += global_height) {
         int y_north = y ? y - 1 : height - 1;
         int y_south = (y + 1) == height ? 0 : y + 1;
-        int i_row = y * width;
-        int i_north = y_north * width;
-        int i_south = y_south * width;
+        long i_row = (long)y * width;
+        long i_north = (long)y_north * width;
+        long i_south = (long)y_south * width;
 
         global char* p_north = grid + i_north;
         global char* p_row = grid + i_row;
@@ -174,3 +174,301 @@ kernel void kernel_width_gt16_pow2(global char* grid, global char* buf, int widt
         }
     }
 }
+
+/* Width greater than 16 and power of 2 like kernel_width_gt16_pow2, that also
+appends an entry of change_stream.hpp for every 16 cells with a cell that 
+changed to changes, at the index taken from count. */
+kernel void kernel_width_gt16_pow2_changes(global char* grid, global char* buf, int width, int height, 
+    global ulong* changes, global uint* count)
+{
+    int x_start = get_global_id(0) * 16;
+    int y_start = get_global_id(1);
+    int global_width = get_global_size(0);
+    int global_height = get_global_size(1);
+    int stride = global_width * 16;
+
+    for (int y = y_start; y < height; y += global_height) {
+        int y_north = y ? y - 1 : height - 1;
+        int y_south = (y + 1) == height ? 0 : y + 1;
+        long i_row = (long)y * width;
+        long i_north = (long)y_north * width;
+        long i_south = (long)y_south * width;
+
+        global char* p_north = grid + i_north;
+        global char* p_row = grid + i_row;
+        global char* p_south = grid + i_south;
+
+        for (int x = x_start; x < width; x += stride) {
+            int x_west = x ? x - 1 : width - 1;
+            int x_east = (x + 16) == width ? 0 : x + 16;
+
+            char16 n_cells = vload16(0, p_north + x);
+            char16 nw_cells = shift_in_first_16(p_north[x_west], n_cells);
+            char16 ne_cells = shift_in_last_16(p_north[x_east], n_cells);
+            
+            char16 cells = vload16(0, p_row + x);
+            char16 w_cells = shift_in_first_16(p_row[x_west], cells);
+            char16 e_cells = shift_in_last_16(p_row[x_east], cells);
+
+            char16 s_cells = vload16(0, p_south + x);
+            char16 sw_cells = shift_in_first_16(p_south[x_west], s_cells);
+            char16 se_cells = shift_in_last_16(p_south[x_east], s_cells);
+
+            char16 neighbors = n_cells + ne_cells + nw_cells + e_cells + w_cells + s_cells + se_cells + sw_cells;
+            char16 alive = (((neighbors == (char16)(3)) | ((neighbors == (char16)(2)) & cells)) & (char16)(1));
+            vstore16(alive, 0, buf + i_row + x);
+
+            // Cell i that changed is bit i of the entry, the bits of the 16
+            // cells are ORed together in halves.
+            ushort16 bits = convert_ushort16(alive ^ cells) << 
+                (ushort16)(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            ushort8 bits_8 = bits.lo | bits.hi;
+            ushort4 bits_4 = bits_8.lo | bits_8.hi;
+            ushort2 bits_2 = bits_4.lo | bits_4.hi;
+            ushort changed = bits_2.x | bits_2.y;
+            if (changed) {
+                changes[atomic_inc(count)] = (ulong)(i_row + x) << 16 | changed;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Stencil kernels for widths greater than 16 and power of 2
+ * 
+ * Neighborhoods other than the 8 cells around a cell, in the same bits as the
+ * stencils of cpu_stencil.hpp. Every stencil is a kernel of its own, so the 
+ * neighbors outside of it are never loaded or added. The stencils with a name
+ * are always built, any other is built as kernel_stencil_custom if the program
+ * is built with -D STENCIL_CUSTOM=<mask>.
+ ******************************************************************************/
+
+#define STENCIL_NW 1
+#define STENCIL_N 2
+#define STENCIL_NE 4
+#define STENCIL_W 8
+#define STENCIL_E 16
+#define STENCIL_SW 32
+#define STENCIL_S 64
+#define STENCIL_SE 128
+
+#define template_stencil(NAME, MASK)                                           \
+kernel void kernel_stencil_##NAME(global char* grid, global char* buf, int width, int height) \
+{                                                                              \
+    int x_start = get_global_id(0) * 16;                                       \
+    int y_start = get_global_id(1);                                            \
+    int global_height = get_global_size(1);                                    \
+    int stride = get_global_size(0) * 16;                                      \
+                                                                               \
+    for (int y = y_start; y < height; y += global_height) {                    \
+        int y_north = y ? y - 1 : height - 1;                                  \
+        int y_south = (y + 1) == height ? 0 : y + 1;                           \
+        long i_row = (long)y * width;                                          \
+        global char* p_north = grid + (long)y_north * width;                   \
+        global char* p_row = grid + i_row;                                     \
+        global char* p_south = grid + (long)y_south * width;                   \
+                                                                               \
+        for (int x = x_start; x < width; x += stride) {                        \
+            int x_west = x ? x - 1 : width - 1;                                \
+            int x_east = (x + 16) == width ? 0 : x + 16;                       \
+                                                                               \
+            char16 cells = vload16(0, p_row + x);                              \
+            char16 neighbors = (char16)(0);                                    \
+            if ((MASK) & STENCIL_NW)                                           \
+                neighbors += shift_in_first_16(p_north[x_west], vload16(0, p_north + x)); \
+            if ((MASK) & STENCIL_N)                                            \
+                neighbors += vload16(0, p_north + x);                          \
+            if ((MASK) & STENCIL_NE)                                           \
+                neighbors += shift_in_last_16(p_north[x_east], vload16(0, p_north + x)); \
+            if ((MASK) & STENCIL_W)                                            \
+                neighbors += shift_in_first_16(p_row[x_west], cells);          \
+            if ((MASK) & STENCIL_E)                                            \
+                neighbors += shift_in_last_16(p_row[x_east], cells);           \
+            if ((MASK) & STENCIL_SW)                                           \
+                neighbors += shift_in_first_16(p_south[x_west], vload16(0, p_south + x)); \
+            if ((MASK) & STENCIL_S)                                            \
+                neighbors += vload16(0, p_south + x);                          \
+            if ((MASK) & STENCIL_SE)                                           \
+                neighbors += shift_in_last_16(p_south[x_east], vload16(0, p_south + x)); \
+                                                                               \
+            char16 alive = (((neighbors == (char16)(3)) | ((neighbors == (char16)(2)) & cells)) & (char16)(1)); \
+            vstore16(alive, 0, buf + i_row + x);                               \
+        }                                                                      \
+    }                                                                          \
+}
+
+template_stencil(moore, 0xff)
+
+template_stencil(von_neumann, STENCIL_N | STENCIL_W | STENCIL_E | STENCIL_S)
+
+template_stencil(hex, 0xff & ~(STENCIL_NE | STENCIL_SW))
+
+#ifdef STENCIL_CUSTOM
+template_stencil(custom, STENCIL_CUSTOM)
+#endif
+
+/*******************************************************************************
+ * Bit-packed kernels for widths that are multiples of 32
+ * 
+ * Cell x of a row is bit x % 32 of word x / 32 of the row. Neighbor counts are
+ * added up bitwise with full adders, 32 or 128 cells per work item at a time.
+ ******************************************************************************/
+
+/* Packs 32 cells per word. */
+kernel void kernel_pack(global char* grid, global uint* bits, long words)
+{
+    for (long i = get_global_id(0); i < words; i += get_global_size(0)) {
+        uint16 lo = convert_uint16(vload16(0, grid + i * 32) & (char16)(1));
+        uint16 hi = convert_uint16(vload16(0, grid + i * 32 + 16) & (char16)(1));
+        uint16 shifts = (uint16)(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        lo <<= shifts;
+        hi <<= shifts + (uint16)(16);
+        uint8 word_8 = lo.lo | lo.hi | hi.lo | hi.hi;
+        uint4 word_4 = word_8.lo | word_8.hi;
+        uint2 word_2 = word_4.lo | word_4.hi;
+        bits[i] = word_2.lo | word_2.hi;
+    }
+}
+
+/* Unpacks 32 cells per word. */
+kernel void kernel_unpack(global uint* bits, global char* grid, long words)
+{
+    for (long i = get_global_id(0); i < words; i += get_global_size(0)) {
+        uint16 shifts = (uint16)(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        uint16 word = (uint16)(bits[i]);
+        vstore16(convert_char16((word >> shifts) & (uint16)(1)), 0, grid + i * 32);
+        vstore16(convert_char16((word >> (shifts + (uint16)(16))) & (uint16)(1)), 0, grid + i * 32 + 16);
+    }
+}
+
+/* Next states of the cells in a word given the words of its 8 neighbors. The
+count of every cell is 3 bits wide, so 8 neighbors wraps around to 0, which is
+dead just like 8. */
+#define template_packed_alive(NAME, T)                                         \
+T NAME(T nw, T n, T ne, T w, T cells, T e, T sw, T s, T se)                    \
+{                                                                              \
+    T sum_n = nw ^ n ^ ne;                                                     \
+    T carry_n = (nw & n) | (ne & (nw ^ n));                                    \
+    T sum_we = w ^ e ^ sw;                                                     \
+    T carry_we = (w & e) | (sw & (w ^ e));                                     \
+    T sum_s = s ^ se;                                                          \
+    T carry_s = s & se;                                                        \
+                                                                               \
+    T ones = sum_n ^ sum_we ^ sum_s;                                           \
+    T carry_ones = (sum_n & sum_we) | (sum_s & (sum_n ^ sum_we));              \
+                                                                               \
+    T sum_twos = carry_n ^ carry_we ^ carry_s;                                 \
+    T carry_twos = (carry_n & carry_we) | (carry_s & (carry_n ^ carry_we));    \
+    T twos = sum_twos ^ carry_ones;                                            \
+    T fours = carry_twos ^ (sum_twos & carry_ones);                            \
+                                                                               \
+    return twos & ~fours & (ones | cells);                                     \
+}
+
+template_packed_alive(packed_alive, uint)
+
+template_packed_alive(packed_alive_4, uint4)
+
+/* One word per work item. */
+kernel void kernel_packed(global uint* grid, global uint* buf, int words, int height)
+{
+    for (int y = get_global_id(1); y < height; y += get_global_size(1)) {
+        int y_north = y ? y - 1 : height - 1;
+        int y_south = (y + 1) == height ? 0 : y + 1;
+
+        global uint* p_north = grid + (long)y_north * words;
+        global uint* p_row = grid + (long)y * words;
+        global uint* p_south = grid + (long)y_south * words;
+        global uint* p_buf = buf + (long)y * words;
+
+        for (int x = get_global_id(0); x < words; x += get_global_size(0)) {
+            int x_west = x ? x - 1 : words - 1;
+            int x_east = (x + 1) == words ? 0 : x + 1;
+
+            // West neighbors are the word shifted towards the higher bits 
+            // with the last bit of the word before shifted in, east neighbors
+            // the other way around.
+            uint n_cells = p_north[x];
+            uint nw_cells = (n_cells << 1) | (p_north[x_west] >> 31);
+            uint ne_cells = (n_cells >> 1) | (p_north[x_east] << 31);
+
+            uint cells = p_row[x];
+            uint w_cells = (cells << 1) | (p_row[x_west] >> 31);
+            uint e_cells = (cells >> 1) | (p_row[x_east] << 31);
+
+            uint s_cells = p_south[x];
+            uint sw_cells = (s_cells << 1) | (p_south[x_west] >> 31);
+            uint se_cells = (s_cells >> 1) | (p_south[x_east] << 31);
+
+            p_buf[x] = packed_alive(nw_cells, n_cells, ne_cells, w_cells, cells, e_cells, 
+                sw_cells, s_cells, se_cells);
+        }
+    }
+}
+
+/* Four words per work item, words must be a multiple of 4. */
+kernel void kernel_packed_4(global uint* grid, global uint* buf, int words, int height)
+{
+    int vecs = words / 4;
+    for (int y = get_global_id(1); y < height; y += get_global_size(1)) {
+        int y_north = y ? y - 1 : height - 1;
+        int y_south = (y + 1) == height ? 0 : y + 1;
+
+        global uint* p_north = grid + (long)y_north * words;
+        global uint* p_row = grid + (long)y * words;
+        global uint* p_south = grid + (long)y_south * words;
+        global uint* p_buf = buf + (long)y * words;
+
+        for (int x = get_global_id(0); x < vecs; x += get_global_size(0)) {
+            int x_west = x ? x * 4 - 1 : words - 1;
+            int x_east = (x + 1) == vecs ? 0 : x * 4 + 4;
+
+            // The words before and after every word of the vector, which come
+            // from the vector itself except at its ends.
+            uint4 n_cells = vload4(x, p_north);
+            uint4 n_west = (uint4)(p_north[x_west], n_cells.s012);
+            uint4 n_east = (uint4)(n_cells.s123, p_north[x_east]);
+            uint4 nw_cells = (n_cells << 1) | (n_west >> 31);
+            uint4 ne_cells = (n_cells >> 1) | (n_east << 31);
+
+            uint4 cells = vload4(x, p_row);
+            uint4 west = (uint4)(p_row[x_west], cells.s012);
+            uint4 east = (uint4)(cells.s123, p_row[x_east]);
+            uint4 w_cells = (cells << 1) | (west >> 31);
+            uint4 e_cells = (cells >> 1) | (east << 31);
+
+            uint4 s_cells = vload4(x, p_south);
+            uint4 s_west = (uint4)(p_south[x_west], s_cells.s012);
+            uint4 s_east = (uint4)(s_cells.s123, p_south[x_east]);
+            uint4 sw_cells = (s_cells << 1) | (s_west >> 31);
+            uint4 se_cells = (s_cells >> 1) | (s_east << 31);
+
+            vstore4(packed_alive_4(nw_cells, n_cells, ne_cells, w_cells, cells, e_cells, sw_cells, s_cells, 
+                se_cells), x, p_buf);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Viewport reduction
+ ******************************************************************************/
+
+/* Reduces a block of scale x scale cells of the viewport at view_x, view_y to
+a pixel per work item, the share of alive cells from 0 to 255, or 255 if any 
+cell is alive when max_pool is set. */
+kernel void kernel_viewport(global char* grid, global uchar* frame, int width, int view_x, int view_y, 
+    int scale, int max_pool)
+{
+    int px = get_global_id(0);
+    int py = get_global_id(1);
+    global char* p = grid + (long)(view_y + py * scale) * width + view_x + px * scale;
+
+    uint count = 0;
+    for (int y = 0; y < scale; y++, p += width) {
+        for (int x = 0; x < scale; x++) {
+            count += p[x];
+        }
+    }
+    uint block_cells = scale * scale;
+    frame[py * get_global_size(0) + px] = max_pool ? (count ? 255 : 0) : (uchar)((ulong)count * 255 / block_cells);
+}
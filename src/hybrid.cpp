@@ -0,0 +1,264 @@
+/**
+ * hybrid.cpp
+ *
+ * Splits the rows of the world between the OpenMP SIMD engine and every
+ * OpenCL device, and moves the split towards whichever is faster for the
+ * world being simulated. Every part is padded with ghost rows that are
+ * exchanged through the host every hybrid_halo generations. In between,
+ * every part simulates its padded band as if it were a whole world. The rows
+ * that are wrong because the top and bottom of the padded band wrap around to
+ * each other never get past the ghost rows.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <CL/cl.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <game_of_life.hpp>
+#include <gpu_ocl.hpp>
+#include <util.hpp>
+
+// Generations between ghost row exchanges, also the number of ghost rows on
+// each side of a part.
+const int hybrid_halo = 8;
+
+// Exchanges between measuring throughput and moving the split.
+const int hybrid_rebalance_period = 4;
+
+// The split is only moved if a part gains or loses at least this fraction of
+// its rows, since moving it means gathering and scattering the whole world.
+const double hybrid_rebalance_threshold = 0.05;
+
+struct hybrid_part
+{
+    // Device of the part, nullptr for the CPU part.
+    gpu_ocl_compiler* ocl;
+
+    // Rows of the world owned by the part.
+    int y_start;
+    int rows;
+
+    // Padded band on the host for the CPU part, on the device otherwise.
+    // flipped is set when the current generation is in buf_d.
+    char* local;
+    cl::Buffer grid_d;
+    cl::Buffer buf_d;
+    bool flipped;
+
+    // Milliseconds spent simulating since the last rebalance.
+    double busy_time;
+};
+
+/* Compilers for every OpenCL device of every platform, including CPU devices.
+Devices that fail to compile the kernels are skipped. */
+static std::vector<std::unique_ptr<gpu_ocl_compiler>> find_devices()
+{
+    std::vector<std::unique_ptr<gpu_ocl_compiler>> compilers;
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    for (cl::Platform& platform : platforms) {
+        std::vector<cl::Device> devices;
+        platform.getDevices(CL_DEVICE_TYPE_ALL, &devices);
+        for (cl::Device& device : devices) {
+            try {
+                compilers.emplace_back(new gpu_ocl_compiler(device));
+            }
+            catch (std::exception&) {
+            }
+        }
+    }
+    return compilers;
+}
+
+/* Copies count rows of the world starting at row y to dst, wrapping around
+the bottom of the world. */
+static void copy_rows_wrapped(char* dst, char* grid, int width, int height, int y, int count)
+{
+    y = (y + height) % height;
+    int first = std::min(count, height - y);
+    memcpy(dst, grid + (size_t)y * width, (size_t)first * width);
+    memcpy(dst + (size_t)first * width, grid, (size_t)(count - first) * width);
+}
+
+/* Moves the band of a part from the world to the part. */
+static void scatter_part(hybrid_part& part, char* grid, int width)
+{
+    size_t local_size = (size_t)(part.rows + 2 * hybrid_halo) * width;
+    char* band = grid + (size_t)part.y_start * width;
+    size_t band_size = (size_t)part.rows * width;
+    if (!part.ocl) {
+        part.local = new char[local_size];
+        memcpy(part.local + (size_t)hybrid_halo * width, band, band_size);
+    }
+    else {
+        part.grid_d = cl::Buffer(part.ocl->context, CL_MEM_READ_WRITE, local_size);
+        part.buf_d = cl::Buffer(part.ocl->context, CL_MEM_READ_WRITE, local_size);
+        part.ocl->queue.enqueueWriteBuffer(part.grid_d, CL_TRUE, (size_t)hybrid_halo * width, band_size, band);
+        part.flipped = false;
+    }
+}
+
+/* Copies count rows of the padded band starting at row y back to the world. */
+static void gather_rows(hybrid_part& part, char* grid, int width, int y, int count)
+{
+    char* dst = grid + (size_t)(part.y_start + y - hybrid_halo) * width;
+    if (!part.ocl) {
+        memcpy(dst, part.local + (size_t)y * width, (size_t)count * width);
+    }
+    else {
+        part.ocl->queue.enqueueReadBuffer(part.flipped ? part.buf_d : part.grid_d, CL_TRUE, (size_t)y * width,
+            (size_t)count * width, dst);
+    }
+}
+
+/* Moves the band of a part from the part back to the world. */
+static void gather_part(hybrid_part& part, char* grid, int width)
+{
+    gather_rows(part, grid, width, hybrid_halo, part.rows);
+    if (!part.ocl) {
+        delete[] part.local;
+    }
+    else {
+        part.grid_d = cl::Buffer();
+        part.buf_d = cl::Buffer();
+    }
+}
+
+/* Assigns consecutive bands of rows to the parts in proportion to their
+weights, with at least hybrid_halo rows each. */
+static void split_rows(std::vector<hybrid_part>& parts, const std::vector<double>& weights, int height)
+{
+    double total = 0;
+    for (double weight : weights) {
+        total += weight;
+    }
+    int spare = height - hybrid_halo * parts.size();
+    int y = 0;
+    for (size_t i = 0; i < parts.size(); i++) {
+        parts[i].y_start = y;
+        parts[i].rows = i + 1 == parts.size() ? height - y : hybrid_halo + (int)(spare * weights[i] / total);
+        y += parts[i].rows;
+    }
+}
+
+void cpu_gpu_hybrid(char* grid, int width, int height, int gens)
+{
+    static std::vector<std::unique_ptr<gpu_ocl_compiler>> devices = find_devices();
+
+    // Every part needs at least as many rows as its neighbors' ghost rows.
+    std::vector<hybrid_part> parts(1);
+    if (gpu_ocl_supports_width(width)) {
+        for (size_t i = 0; i < devices.size() && (int)(parts.size() + 1) * hybrid_halo <= height; i++) {
+            parts.push_back(hybrid_part());
+            parts.back().ocl = devices[i].get();
+        }
+    }
+    if (parts.size() == 1 || gens <= 0) {
+        cpu_omp(grid, width, height, gens);
+        return;
+    }
+    parts[0].ocl = nullptr;
+
+    split_rows(parts, std::vector<double>(parts.size(), 1.0), height);
+    for (hybrid_part& part : parts) {
+        scatter_part(part, grid, width);
+        part.busy_time = 0;
+    }
+
+    size_t halo_size = (size_t)hybrid_halo * width;
+    char* ghosts = new char[halo_size * 2];
+    int window_gens = 0;
+    for (int i = 0, exchanges = 1; i < gens; i += hybrid_halo, exchanges++) {
+        int steps = std::min(hybrid_halo, gens - i);
+
+        // Ghost rows come from the world, where the neighbors left their
+        // first and last rows at the end of the last exchange.
+        for (hybrid_part& part : parts) {
+            int local_rows = part.rows + 2 * hybrid_halo;
+            if (!part.ocl) {
+                copy_rows_wrapped(part.local, grid, width, height, part.y_start - hybrid_halo, hybrid_halo);
+                copy_rows_wrapped(part.local + (size_t)(local_rows - hybrid_halo) * width, grid, width, height,
+                    part.y_start + part.rows, hybrid_halo);
+            }
+            else {
+                cl::Buffer& current = part.flipped ? part.buf_d : part.grid_d;
+                copy_rows_wrapped(ghosts, grid, width, height, part.y_start - hybrid_halo, hybrid_halo);
+                copy_rows_wrapped(ghosts + halo_size, grid, width, height, part.y_start + part.rows, hybrid_halo);
+                part.ocl->queue.enqueueWriteBuffer(current, CL_FALSE, 0, halo_size, ghosts);
+                part.ocl->queue.enqueueWriteBuffer(current, CL_FALSE, (size_t)(local_rows - hybrid_halo) * width,
+                    halo_size, ghosts + halo_size);
+                part.ocl->queue.finish();
+            }
+        }
+
+        // Devices are driven from their own threads so that their throughput
+        // is measured separately from the CPU part running on this thread.
+        std::vector<std::thread> drivers;
+        for (size_t p = 1; p < parts.size(); p++) {
+            drivers.emplace_back([&parts, p, width, steps]() {
+                hybrid_part& part = parts[p];
+                my_timer timer;
+                timer.start();
+                cl::Buffer& current = part.flipped ? part.buf_d : part.grid_d;
+                cl::Buffer& next = part.flipped ? part.grid_d : part.buf_d;
+                gpu_ocl_enqueue(*part.ocl, current, next, width, part.rows + 2 * hybrid_halo, steps);
+                part.ocl->queue.finish();
+                part.flipped ^= steps & 1;
+                part.busy_time += timer.stop();
+            });
+        }
+        my_timer timer;
+        timer.start();
+        cpu_omp(parts[0].local, width, parts[0].rows + 2 * hybrid_halo, steps);
+        parts[0].busy_time += timer.stop();
+        for (std::thread& driver : drivers) {
+            driver.join();
+        }
+
+        // First and last rows of every band become the neighbors' ghost rows.
+        for (hybrid_part& part : parts) {
+            gather_rows(part, grid, width, hybrid_halo, hybrid_halo);
+            gather_rows(part, grid, width, part.rows, hybrid_halo);
+        }
+        window_gens += steps;
+
+        // Splits rows in proportion to the rows per millisecond of every part.
+        if (!(exchanges % hybrid_rebalance_period) && i + hybrid_halo < gens) {
+            std::vector<double> throughputs;
+            for (hybrid_part& part : parts) {
+                throughputs.push_back((double)part.rows * window_gens / std::max(part.busy_time, 1e-3));
+                part.busy_time = 0;
+            }
+            window_gens = 0;
+
+            std::vector<hybrid_part> balanced = parts;
+            split_rows(balanced, throughputs, height);
+            bool moved = false;
+            for (size_t p = 0; p < parts.size(); p++) {
+                if (std::abs(balanced[p].rows - parts[p].rows) > hybrid_rebalance_threshold * parts[p].rows) {
+                    moved = true;
+                }
+            }
+            if (moved) {
+                for (hybrid_part& part : parts) {
+                    gather_part(part, grid, width);
+                }
+                parts = balanced;
+                for (hybrid_part& part : parts) {
+                    scatter_part(part, grid, width);
+                }
+            }
+        }
+    }
+
+    for (hybrid_part& part : parts) {
+        gather_part(part, grid, width);
+    }
+    delete[] ghosts;
+}
@@ -0,0 +1,349 @@
+/**
+ * sim_auto.cpp
+ *
+ * Engine selection from a measured profile of the host, see sim_auto.hpp.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <CL/cl.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <omp.h>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+#include <cpu_simd.hpp>
+#include <game_of_life.hpp>
+#include <gpu_ocl.hpp>
+#include <sim_auto.hpp>
+#include <util.hpp>
+
+// First line of a profile, changed whenever what is measured changes so that
+// older profiles are measured again.
+const char* sim_auto_version = "sim_auto 1";
+
+// A width of every width class the engines dispatch on, see
+// sim_auto_width_class(), and the world sizes measured for each.
+const int sim_auto_widths[] = {4, 8, 64, 1024};
+const size_t sim_auto_cells[] = {(size_t)1 << 14, (size_t)1 << 17, (size_t)1 << 20, (size_t)1 << 23};
+
+// Runs of which the fastest is kept.
+const int sim_auto_reps = 3;
+
+struct sim_auto_entry
+{
+    int width_class;
+    size_t cells;
+    sim_auto_choice choice;
+    double fixed_time;
+    double gen_time;
+};
+
+struct sim_auto_profile
+{
+    std::string host;
+    std::vector<sim_auto_entry> entries;
+};
+
+static std::mutex sim_auto_mutex;
+static std::shared_ptr<const sim_auto_profile> sim_auto_current;
+
+/* Returns the width class of the row kernels the engines use for a width:
+the fixed width kernels, the 16 cell vectors, and the 8 and 4 cell integers. */
+static int sim_auto_width_class(int width)
+{
+    if (cpu_simd_fixed_rows_for(width)) {
+        return 2;
+    }
+    else if (width >= 16) {
+        return 3;
+    }
+    else if (width >= 8) {
+        return 1;
+    }
+    return 0;
+}
+
+/* Returns what identifies the hardware of the host: the processor, the
+number of processors and the default OpenCL device and driver. */
+static std::string sim_auto_host()
+{
+    std::string cpu = "unknown";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line);) {
+        if (!line.compare(0, 10, "model name") && line.find(':') != std::string::npos) {
+            cpu = line.substr(line.find(':') + 1);
+            cpu.erase(0, cpu.find_first_not_of(' '));
+            break;
+        }
+    }
+    std::string host = cpu + "; " + std::to_string(omp_get_num_procs()) + " processors";
+
+    cl_int err = CL_SUCCESS;
+    cl::Device device = cl::Device::getDefault(&err);
+    if (!err) {
+        std::string device_name = device.getInfo<CL_DEVICE_NAME>();
+        std::string driver_version = device.getInfo<CL_DRIVER_VERSION>();
+        host += "; " + device_name + " " + driver_version;
+    }
+    return host;
+}
+
+const char* sim_auto_engine_name(int engine)
+{
+    switch (engine) {
+        case sim_auto_cpu_simd:
+            return "cpu_simd";
+        case sim_auto_cpu_simd_rowsum:
+            return "cpu_simd_rowsum";
+        case sim_auto_cpu_omp:
+            return "cpu_omp";
+        case sim_auto_gpu_ocl:
+            return "gpu_ocl";
+        default:
+            throw std::invalid_argument("unknown engine " + std::to_string(engine));
+    }
+}
+
+/* Simulates the world on the chosen engine. */
+static void sim_auto_run(const sim_auto_choice& choice, char* grid, int width, int height, int gens)
+{
+    switch (choice.engine) {
+        case sim_auto_cpu_simd:
+            cpu_simd(grid, width, height, gens);
+            break;
+        case sim_auto_cpu_simd_rowsum:
+            cpu_simd_rowsum(grid, width, height, gens);
+            break;
+        case sim_auto_cpu_omp:
+            cpu_omp_threads(grid, width, height, gens, choice.threads);
+            break;
+        case sim_auto_gpu_ocl:
+            gpu_ocl(grid, width, height, gens);
+            break;
+        default:
+            throw std::invalid_argument("unknown engine " + std::to_string(choice.engine));
+    }
+}
+
+/* Returns the fastest of sim_auto_reps runs of gens generations of a copy of
+world in ms. */
+static double sim_auto_time(const sim_auto_choice& choice, const char* world, char* grid, int width, int height,
+    int gens)
+{
+    size_t size = (size_t)width * height;
+    double best = -1;
+    for (int i = 0; i < sim_auto_reps; i++) {
+        memcpy(grid, world, size);
+        my_timer timer;
+        timer.start();
+        sim_auto_run(choice, grid, width, height, gens);
+        double time = timer.stop();
+        if (best < 0 || time < best) {
+            best = time;
+        }
+    }
+    return best;
+}
+
+/* Measures every engine on every width class and world size. Engines with a
+thread count are measured with powers of two threads and every processor. */
+static sim_auto_profile sim_auto_measure()
+{
+    sim_auto_profile profile;
+    profile.host = sim_auto_host();
+
+    std::vector<sim_auto_choice> choices = {{sim_auto_cpu_simd, 1}, {sim_auto_cpu_simd_rowsum, 1}};
+    int procs = omp_get_num_procs();
+    for (int threads = 2; threads < procs; threads *= 2) {
+        choices.push_back({sim_auto_cpu_omp, threads});
+    }
+    if (procs > 1) {
+        choices.push_back({sim_auto_cpu_omp, procs});
+    }
+    choices.push_back({sim_auto_gpu_ocl, 0});
+    bool gpu = true;
+
+    for (int width : sim_auto_widths) {
+        for (size_t cells : sim_auto_cells) {
+            int height = std::max((size_t)3, cells / width);
+            size_t size = (size_t)width * height;
+            std::vector<char> world(size), grid(size);
+            for (size_t i = 0; i < size; i++) {
+                world[i] = rand() % 4 == 0;
+            }
+
+            // Enough generations that the smaller worlds take longer than
+            // the timer's resolution, and the time per generation is the
+            // difference between runs of gens and twice as many generations.
+            int gens = std::max((size_t)2, std::min((size_t)64, ((size_t)1 << 24) / size));
+            for (const sim_auto_choice& choice : choices) {
+                if (choice.engine == sim_auto_gpu_ocl && !gpu) {
+                    continue;
+                }
+                double time, time_2;
+                try {
+                    time = sim_auto_time(choice, world.data(), grid.data(), width, height, gens);
+                    time_2 = sim_auto_time(choice, world.data(), grid.data(), width, height, 2 * gens);
+                }
+                catch (std::exception&) {
+                    // No OpenCL device, or one that cannot build the kernels.
+                    if (choice.engine != sim_auto_gpu_ocl) {
+                        throw;
+                    }
+                    gpu = false;
+                    continue;
+                }
+                double gen_time = std::max(0.0, (time_2 - time) / gens);
+                double fixed_time = std::max(0.0, time - gen_time * gens);
+                profile.entries.push_back(sim_auto_entry{sim_auto_width_class(width), size, choice, fixed_time,
+                    gen_time});
+            }
+        }
+    }
+    return profile;
+}
+
+std::string sim_auto_profile_path()
+{
+    const char* path = getenv("GOL_AUTO_PROFILE");
+    if (path && *path) {
+        return path;
+    }
+    std::string dir = cache_dir();
+    return dir.empty() ? "" : dir + "/auto_profile.txt";
+}
+
+/* Reads the profile at path into profile, returns false if there is none or
+it is not readable by this version. */
+static bool sim_auto_load(const std::string& path, sim_auto_profile& profile)
+{
+    if (path.empty()) {
+        return false;
+    }
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line) || line != sim_auto_version) {
+        return false;
+    }
+    if (!std::getline(file, line) || line.compare(0, 5, "host ")) {
+        return false;
+    }
+    profile.host = line.substr(5);
+    profile.entries.clear();
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        sim_auto_entry entry;
+        if (!(fields >> entry.width_class >> entry.cells >> entry.choice.engine >> entry.choice.threads >>
+            entry.fixed_time >> entry.gen_time)) {
+            return false;
+        }
+        profile.entries.push_back(entry);
+    }
+    return !profile.entries.empty();
+}
+
+/* Writes the profile to path. Failing to write it only means it is measured
+again by the next process. */
+static void sim_auto_store(const std::string& path, const sim_auto_profile& profile)
+{
+    if (path.empty()) {
+        return;
+    }
+
+    // Writes to a file of this process first so that other processes never
+    // read a partial profile.
+    std::string temp_path = path + "." + std::to_string(getpid());
+    {
+        std::ofstream file(temp_path);
+        file << sim_auto_version << "\n" << "host " << profile.host << "\n";
+        for (const sim_auto_entry& entry : profile.entries) {
+            file << entry.width_class << " " << entry.cells << " " << entry.choice.engine << " " <<
+                entry.choice.threads << " " << entry.fixed_time << " " << entry.gen_time << "\n";
+        }
+        if (!file) {
+            file.close();
+            unlink(temp_path.c_str());
+            return;
+        }
+    }
+    if (rename(temp_path.c_str(), path.c_str())) {
+        unlink(temp_path.c_str());
+    }
+}
+
+/* Returns the profile of this host, loaded or measured on first use. */
+static std::shared_ptr<const sim_auto_profile> sim_auto_get_profile()
+{
+    std::lock_guard<std::mutex> lock(sim_auto_mutex);
+    if (sim_auto_current) {
+        return sim_auto_current;
+    }
+    std::string path = sim_auto_profile_path();
+    std::shared_ptr<sim_auto_profile> profile(new sim_auto_profile());
+    if (!sim_auto_load(path, *profile) || profile->host != sim_auto_host()) {
+        *profile = sim_auto_measure();
+        sim_auto_store(path, *profile);
+    }
+    sim_auto_current = profile;
+    return sim_auto_current;
+}
+
+void sim_auto_calibrate()
+{
+    std::shared_ptr<sim_auto_profile> profile(new sim_auto_profile(sim_auto_measure()));
+    std::lock_guard<std::mutex> lock(sim_auto_mutex);
+    sim_auto_store(sim_auto_profile_path(), *profile);
+    sim_auto_current = profile;
+}
+
+sim_auto_choice sim_auto_choose(int width, int height, int gens)
+{
+    if (width < 1 || height < 1) {
+        throw std::invalid_argument("width and height must be at least 1");
+    }
+    std::shared_ptr<const sim_auto_profile> profile = sim_auto_get_profile();
+    int width_class = sim_auto_width_class(width);
+    size_t cells = (size_t)width * height;
+
+    // Measured size of the width class nearest to the world on a log scale.
+    size_t nearest = 0;
+    for (const sim_auto_entry& entry : profile->entries) {
+        if (entry.width_class == width_class && (!nearest ||
+            std::fabs(std::log((double)entry.cells / cells)) < std::fabs(std::log((double)nearest / cells)))) {
+            nearest = entry.cells;
+        }
+    }
+
+    sim_auto_choice best = {sim_auto_cpu_omp, omp_get_num_procs()};
+    double best_time = -1;
+    double scale = (double)cells / nearest;
+    for (const sim_auto_entry& entry : profile->entries) {
+        if (entry.width_class != width_class || entry.cells != nearest) {
+            continue;
+        }
+        if (entry.choice.engine == sim_auto_gpu_ocl && !gpu_ocl_supports_width(width)) {
+            continue;
+        }
+        double time = scale * (entry.fixed_time + gens * entry.gen_time);
+        if (best_time < 0 || time < best_time) {
+            best = entry.choice;
+            best_time = time;
+        }
+    }
+    return best;
+}
+
+void sim_auto(char* grid, int width, int height, int gens)
+{
+    sim_auto_run(sim_auto_choose(width, height, gens), grid, width, height, gens);
+}
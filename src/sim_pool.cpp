@@ -0,0 +1,219 @@
+/**
+ * sim_pool.cpp
+ *
+ * Persistent thread pool shared by concurrent simulations. A job is advanced
+ * one generation at a time, every generation split into bands that any thread
+ * can take. The thread that finishes the last band of a generation moves the
+ * job to the next one.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <omp.h>
+#include <stdexcept>
+
+#include <cpu_simd.hpp>
+#include <sim_pool.hpp>
+#include <util.hpp>
+
+// Cells per band. Small enough that a large world is split between every
+// thread, large enough that taking a band is rare compared to computing it.
+const size_t sim_pool_band_cells = 16384;
+
+typedef std::chrono::steady_clock sim_clock;
+
+struct sim_pool::job
+{
+    char* world;
+    char* grid;
+    char* buf;
+    int width;
+    int height;
+    int gens;
+    int priority;
+
+    // Generation being computed, bands of it handed out and finished.
+    int gen;
+    int bands;
+    int next_band;
+    int done_bands;
+
+    // Cells handed out so far, for fair share between jobs of a priority.
+    double service;
+
+    bool started;
+    sim_clock::time_point submit_time;
+    sim_clock::time_point start_time;
+    std::promise<sim_job_stats> result;
+};
+
+sim_pool::sim_pool(int threads) : _stop(false)
+{
+    if (threads <= 0) {
+        threads = omp_get_num_procs();
+    }
+    for (int i = 0; i < threads; i++) {
+        _threads.emplace_back(&sim_pool::run, this);
+    }
+}
+
+sim_pool::~sim_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _work.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+std::future<sim_job_stats> sim_pool::submit(char* grid, int width, int height, int gens, int priority)
+{
+    if (width < 1 || height < 1) {
+        throw std::invalid_argument("width and height must be at least 1");
+    }
+    if (gens < 0) {
+        throw std::invalid_argument("gens must not be negative");
+    }
+    if (priority < sim_priority_low || priority > sim_priority_high) {
+        throw std::invalid_argument("priority must be a sim_priority");
+    }
+    size_t size = (size_t)width * height;
+
+    std::unique_ptr<job> j(new job());
+    j->world = grid;
+    j->grid = grid;
+    j->buf = gens ? new char[size] : nullptr;
+    j->width = width;
+    j->height = height;
+    j->gens = gens;
+    j->priority = priority;
+    j->gen = 0;
+    j->bands = std::max(1, (int)std::min((size_t)height, size / sim_pool_band_cells));
+    j->next_band = 0;
+    j->done_bands = 0;
+    j->started = false;
+    j->submit_time = sim_clock::now();
+    std::future<sim_job_stats> future = j->result.get_future();
+
+    if (!gens) {
+        j->result.set_value(sim_job_stats{0, 0});
+        return future;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // A new job starts with the least service of the jobs of its priority,
+        // so that it does not run alone until it has caught up with them.
+        double service = -1;
+        for (std::unique_ptr<job>& other : _jobs) {
+            if (other->priority == priority && (service < 0 || other->service < service)) {
+                service = other->service;
+            }
+        }
+        j->service = std::max(service, 0.0);
+        _jobs.push_back(std::move(j));
+    }
+    _work.notify_all();
+    return future;
+}
+
+/* Returns the job with a band to hand out that goes next, nullptr if there is
+none. Called with the lock held. */
+sim_pool::job* sim_pool::next_job()
+{
+    job* next = nullptr;
+    for (std::unique_ptr<job>& j : _jobs) {
+        if (j->next_band == j->bands) {
+            continue;
+        }
+        if (!next || j->priority > next->priority || (j->priority == next->priority && j->service < next->service)) {
+            next = j.get();
+        }
+    }
+    return next;
+}
+
+void sim_pool::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        job* j = nullptr;
+        _work.wait(lock, [this, &j]() {
+            j = next_job();
+            return j || (_stop && _jobs.empty());
+        });
+        if (!j) {
+            return;
+        }
+
+        int band = j->next_band++;
+        int y_start = (int)((int64_t)band * j->height / j->bands);
+        int y_end = (int)((int64_t)(band + 1) * j->height / j->bands);
+        j->service += (double)(y_end - y_start) * j->width;
+        if (!j->started) {
+            j->started = true;
+            j->start_time = sim_clock::now();
+        }
+        char* grid = j->grid;
+        char* buf = j->buf;
+        int width = j->width;
+        int height = j->height;
+        lock.unlock();
+
+        for (int y = y_start; y < y_end; y++) {
+            int y_north = y ? y - 1 : height - 1;
+            int y_south = y < height - 1 ? y + 1 : 0;
+            cpu_simd_row(grid, buf, width, y, y_north, y_south);
+        }
+
+        lock.lock();
+        if (++j->done_bands < j->bands) {
+            continue;
+        }
+
+        // Last band of the generation, the next generation can be handed out.
+        swap_ptr((void**)&j->grid, (void**)&j->buf);
+        j->gen++;
+        j->next_band = 0;
+        j->done_bands = 0;
+        if (j->gen < j->gens) {
+            _work.notify_all();
+            continue;
+        }
+
+        // The job leaves the pool before its result is copied, so that the
+        // other jobs are not held up meanwhile.
+        std::unique_ptr<job> finished;
+        for (std::list<std::unique_ptr<job>>::iterator it = _jobs.begin(); it != _jobs.end(); it++) {
+            if (it->get() == j) {
+                finished = std::move(*it);
+                _jobs.erase(it);
+                break;
+            }
+        }
+        if (_stop && _jobs.empty()) {
+            _work.notify_all();
+        }
+        lock.unlock();
+
+        // If number of generations is odd, the result is in buf, so copy to
+        // the world.
+        if (j->grid != j->world) {
+            memcpy(j->world, j->grid, (size_t)width * height);
+            j->buf = j->grid;
+        }
+        delete[] j->buf;
+        sim_clock::time_point end_time = sim_clock::now();
+        std::chrono::duration<double, std::milli> queue_time = j->start_time - j->submit_time;
+        std::chrono::duration<double, std::milli> compute_time = end_time - j->start_time;
+        j->result.set_value(sim_job_stats{queue_time.count(), compute_time.count()});
+        lock.lock();
+    }
+}
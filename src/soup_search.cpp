@@ -0,0 +1,855 @@
+/**
+ * soup_search.cpp
+ *
+ * Random soup search with an object census, see soup_search.hpp.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <omp.h>
+#include <unordered_map>
+#include <vector>
+
+#include <soup_search.hpp>
+#include <util.hpp>
+
+// Words of a row of the board.
+const int soup_words = soup_board_size / 64;
+
+// Cells this close to the edges of the board may be born past them, so the
+// objects they belong to are removed or the soup is given up on.
+const int soup_edge_rows = 2;
+
+// Objects wider or taller than this are not identified, so that they fit
+// on a board of their own with room to move.
+const int soup_max_object_size = 40;
+
+// Generations a spaceship at the edge may take to return to its shape.
+const int soup_max_spaceship_period = 4;
+
+// Soups handed to a thread at a time.
+const int soup_chunk = 64;
+
+/* Row of the board, bit x of word i is the cell in column 64 * i + x. */
+struct soup_row
+{
+    uint64_t words[soup_words];
+
+    inline explicit operator bool() const
+    {
+        uint64_t any = 0;
+        for (int i = 0; i < soup_words; i++) {
+            any |= words[i];
+        }
+        return any;
+    };
+};
+
+struct soup_board
+{
+    soup_row rows[soup_board_size];
+};
+
+/* Names of identified objects, by the normalized cells of one of their
+phases. */
+typedef std::unordered_map<std::string, std::string> soup_names;
+
+#define SOUP_ROW_OP(op) \
+    static inline soup_row operator op(const soup_row& a, const soup_row& b) \
+    { \
+        soup_row row; \
+        for (int i = 0; i < soup_words; i++) { \
+            row.words[i] = a.words[i] op b.words[i]; \
+        } \
+        return row; \
+    } \
+    static inline soup_row& operator op##=(soup_row& a, const soup_row& b) \
+    { \
+        for (int i = 0; i < soup_words; i++) { \
+            a.words[i] op##= b.words[i]; \
+        } \
+        return a; \
+    }
+
+SOUP_ROW_OP(&)
+SOUP_ROW_OP(|)
+SOUP_ROW_OP(^)
+
+static inline soup_row operator~(const soup_row& a)
+{
+    soup_row row;
+    for (int i = 0; i < soup_words; i++) {
+        row.words[i] = ~a.words[i];
+    }
+    return row;
+}
+
+static inline bool operator==(const soup_row& a, const soup_row& b)
+{
+    return !(a ^ b);
+}
+
+static inline bool operator!=(const soup_row& a, const soup_row& b)
+{
+    return !(a == b);
+}
+
+/* Moves the cells of a row n columns right, toward higher columns. */
+static inline soup_row operator<<(const soup_row& a, int n)
+{
+    soup_row row = {};
+    int words = n / 64, bits = n % 64;
+    for (int i = soup_words - 1; i >= words; i--) {
+        row.words[i] = a.words[i - words] << bits;
+        if (bits && i > words) {
+            row.words[i] |= a.words[i - words - 1] >> (64 - bits);
+        }
+    }
+    return row;
+}
+
+/* Moves the cells of a row n columns left. */
+static inline soup_row operator>>(const soup_row& a, int n)
+{
+    soup_row row = {};
+    int words = n / 64, bits = n % 64;
+    for (int i = 0; i < soup_words - words; i++) {
+        row.words[i] = a.words[i + words] >> bits;
+        if (bits && i < soup_words - words - 1) {
+            row.words[i] |= a.words[i + words + 1] << (64 - bits);
+        }
+    }
+    return row;
+}
+
+/* Returns a row with only the cell in column x alive. */
+static inline soup_row soup_cell(int x)
+{
+    soup_row row = {};
+    row.words[x / 64] = 1ULL << (x % 64);
+    return row;
+}
+
+static inline int soup_popcount(const soup_row& row)
+{
+    int population = 0;
+    for (int i = 0; i < soup_words; i++) {
+        population += __builtin_popcountll(row.words[i]);
+    }
+    return population;
+}
+
+/* Returns the column of the first alive cell of a row that has one. */
+static inline int soup_first(const soup_row& row)
+{
+    int i = 0;
+    while (!row.words[i]) {
+        i++;
+    }
+    return 64 * i + __builtin_ctzll(row.words[i]);
+}
+
+/* Returns the column of the last alive cell of a row that has one. */
+static inline int soup_last(const soup_row& row)
+{
+    int i = soup_words - 1;
+    while (!row.words[i]) {
+        i--;
+    }
+    return 64 * i + 63 - __builtin_clzll(row.words[i]);
+}
+
+static const soup_row soup_edge_columns = soup_cell(0) | soup_cell(1) | soup_cell(soup_board_size - 2) |
+    soup_cell(soup_board_size - 1);
+
+/* Returns the next state of a word of a row from the words above and below it,
+and the same words shifted by a column to the west and east with the cells of
+the words next to them. */
+static inline uint64_t soup_next_word(uint64_t n, uint64_t n_w, uint64_t n_e, uint64_t c_w, uint64_t c,
+    uint64_t c_e, uint64_t s, uint64_t s_w, uint64_t s_e)
+{
+    // Sums of the 3 cells above and below every cell, as ones and twos.
+    uint64_t n1 = n ^ n_w ^ n_e, n2 = (n & n_w) | (n_e & (n ^ n_w));
+    uint64_t s1 = s ^ s_w ^ s_e, s2 = (s & s_w) | (s_e & (s ^ s_w));
+    uint64_t c1 = c_w ^ c_e, c2 = c_w & c_e;
+
+    // The ones of the neighbor count, and the twos still to add.
+    uint64_t ones = n1 ^ s1 ^ c1;
+    uint64_t carry = (n1 & s1) | (c1 & (n1 ^ s1));
+
+    // The count is 2 or 3 when exactly one of the twos is set, any more makes
+    // it at least 4.
+    uint64_t twos = n2 ^ s2 ^ c2 ^ carry;
+    uint64_t many = (n2 & s2) | (c2 & carry) | ((n2 ^ s2) & (c2 ^ carry));
+    return twos & ~many & (ones | c);
+}
+
+/* Alive cells of all rows of a board together, and its first and last alive
+row, last is -1 if the board is empty. */
+struct soup_state
+{
+    soup_row any;
+    int first;
+    int last;
+};
+
+static inline soup_state soup_begin_state()
+{
+    soup_state state = {soup_row(), soup_board_size, -1};
+    return state;
+}
+
+/* Adds an alive row of a board to its state, rows must be added in order. */
+static inline void soup_add_row(soup_state& state, const soup_row& row, int y)
+{
+    state.any |= row;
+    state.first = std::min(state.first, y);
+    state.last = y;
+}
+
+static inline bool soup_near_edge(const soup_state& state)
+{
+    return state.last >= 0 && (state.first < soup_edge_rows || state.last >= soup_board_size - soup_edge_rows ||
+        (state.any & soup_edge_columns));
+}
+
+static soup_state soup_scan(const soup_board& board)
+{
+    soup_state state = soup_begin_state();
+    for (int y = 0; y < soup_board_size; y++) {
+        if (board.rows[y]) {
+            soup_add_row(state, board.rows[y], y);
+        }
+    }
+    return state;
+}
+
+/* Returns the next state of word i of a row from the row and the rows above and
+below it. */
+static inline uint64_t soup_next(const soup_row& north, const soup_row& center, const soup_row& south, int i)
+{
+    uint64_t n = north.words[i], c = center.words[i], s = south.words[i];
+    uint64_t n_w = n << 1, n_e = n >> 1;
+    uint64_t c_w = c << 1, c_e = c >> 1;
+    uint64_t s_w = s << 1, s_e = s >> 1;
+    if (i > 0) {
+        n_w |= north.words[i - 1] >> 63;
+        c_w |= center.words[i - 1] >> 63;
+        s_w |= south.words[i - 1] >> 63;
+    }
+    if (i < soup_words - 1) {
+        n_e |= north.words[i + 1] << 63;
+        c_e |= center.words[i + 1] << 63;
+        s_e |= south.words[i + 1] << 63;
+    }
+    return soup_next_word(n, n_w, n_e, c_w, c, c_e, s, s_w, s_e);
+}
+
+/* Simulates a board in a state one generation and returns its next state. Only
+the words with alive cells and the words next to them are computed. */
+static soup_state soup_step(soup_board& board, const soup_state& state)
+{
+    soup_state next = soup_begin_state();
+    if (state.last < 0) {
+        return next;
+    }
+    int y0 = std::max(state.first - 1, 0), y1 = std::min(state.last + 1, soup_board_size - 1);
+    int i0 = soup_first(state.any) / 64, i1 = soup_last(state.any) / 64;
+    i0 = std::max(i0 - 1, 0);
+    i1 = std::min(i1 + 1, soup_words - 1);
+
+    soup_row north = {};
+    for (int y = y0; y <= y1; y++) {
+        soup_row center = board.rows[y];
+        soup_row south = y < soup_board_size - 1 ? board.rows[y + 1] : soup_row();
+        soup_row& row = board.rows[y];
+        for (int i = i0; i <= i1; i++) {
+            row.words[i] = soup_next(north, center, south, i);
+        }
+        if (row) {
+            soup_add_row(next, row, y);
+        }
+        north = center;
+    }
+    return next;
+}
+
+static inline uint64_t soup_mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Returns the part of the hash of a board of word i of row y, 0 for an empty
+word. The hash is the sum of the parts, so it is updated word by word. */
+static inline uint64_t soup_hash_word(uint64_t word, int y, int i)
+{
+    return word ? soup_mix(word ^ soup_mix((uint64_t)y * soup_words + i + 1)) : 0;
+}
+
+/* Soup simulated in place of the previous generation, with the words of every
+row that differ from 2 generations before. A word whose neighbors did not
+change since 2 generations before takes the state it had a generation before,
+which is still in the board being overwritten, so only words next to changed
+words are computed. Ash of still lifes and blinkers is then nearly free. */
+struct soup_world
+{
+    // Generation gen in boards[gen % 2], gen - 1 in the other one.
+    soup_board boards[2];
+
+    // Bit i of changed[b][y] is set if word i of row y of boards[b] changed
+    // when it was last computed, for rows first_changed[b] to last_changed[b].
+    uint64_t changed[2][soup_board_size];
+    int first_changed[2];
+    int last_changed[2];
+
+    uint64_t hashes[2];
+    int gen;
+
+    // Set when a cell was born near the edges.
+    bool near_edge;
+};
+
+static_assert(soup_board_size / 64 <= 64, "changed words of a row must fit in a uint64_t");
+
+/* Starts a world at a board, as if it came from empty generations. */
+static void soup_world_start(soup_world& world, const soup_board& board)
+{
+    world.gen = 0;
+    world.boards[0] = board;
+    memset(&world.boards[1], 0, sizeof(soup_board));
+    memset(world.changed, 0, sizeof(world.changed));
+    world.hashes[0] = world.hashes[1] = 0;
+
+    // The words of the board are marked as changed in both boards, since the
+    // board does not come from the empty generation before it. The marks of
+    // the other board are kept by the first step.
+    soup_state state = soup_begin_state();
+    for (int y = 0; y < soup_board_size; y++) {
+        for (int i = 0; i < soup_words; i++) {
+            uint64_t word = board.rows[y].words[i];
+            if (word) {
+                world.changed[0][y] |= 1ULL << i;
+                world.hashes[0] += soup_hash_word(word, y, i);
+            }
+        }
+        world.changed[1][y] = world.changed[0][y];
+        if (board.rows[y]) {
+            soup_add_row(state, board.rows[y], y);
+        }
+    }
+    world.first_changed[0] = world.first_changed[1] = state.first;
+    world.last_changed[0] = world.last_changed[1] = state.last;
+    world.near_edge = soup_near_edge(state);
+}
+
+static inline const soup_board& soup_world_board(const soup_world& world)
+{
+    return world.boards[world.gen & 1];
+}
+
+static inline uint64_t soup_world_hash(const soup_world& world)
+{
+    return world.hashes[world.gen & 1];
+}
+
+/* Simulates a world one generation. */
+static void soup_world_step(soup_world& world)
+{
+    int b = world.gen & 1;
+    const soup_board& board = world.boards[b];
+    const uint64_t* changed = world.changed[b];
+    soup_board& next = world.boards[b ^ 1];
+    uint64_t* next_changed = world.changed[b ^ 1];
+    uint64_t hash = world.hashes[b ^ 1];
+    int first = soup_board_size, last = -1;
+    bool near_edge = false;
+    if (!world.gen) {
+        first = world.first_changed[b ^ 1];
+        last = world.last_changed[b ^ 1];
+    }
+    else {
+        for (int y = world.first_changed[b ^ 1]; y <= world.last_changed[b ^ 1]; y++) {
+            next_changed[y] = 0;
+        }
+    }
+
+    const uint64_t all_words = soup_words == 64 ? ~0ULL : (1ULL << soup_words) - 1;
+    int y0 = std::max(world.first_changed[b] - 1, 0);
+    int y1 = std::min(world.last_changed[b] + 1, soup_board_size - 1);
+    for (int y = y0; y <= y1; y++) {
+        uint64_t around = changed[y];
+        if (y > 0) {
+            around |= changed[y - 1];
+        }
+        if (y < soup_board_size - 1) {
+            around |= changed[y + 1];
+        }
+        around = (around | around << 1 | around >> 1) & all_words;
+        if (!around) {
+            continue;
+        }
+        const soup_row empty = {};
+        const soup_row& north = y > 0 ? board.rows[y - 1] : empty;
+        const soup_row& south = y < soup_board_size - 1 ? board.rows[y + 1] : empty;
+        uint64_t row_changed = 0;
+        for (; around; around &= around - 1) {
+            int i = __builtin_ctzll(around);
+            uint64_t word = soup_next(north, board.rows[y], south, i);
+            uint64_t old = next.rows[y].words[i];
+            if (word == old) {
+                continue;
+            }
+            next.rows[y].words[i] = word;
+            row_changed |= 1ULL << i;
+            hash += soup_hash_word(word, y, i) - soup_hash_word(old, y, i);
+            if (word && (y < soup_edge_rows || y >= soup_board_size - soup_edge_rows ||
+                (word & soup_edge_columns.words[i]))) {
+                near_edge = true;
+            }
+        }
+        if (row_changed) {
+            next_changed[y] |= row_changed;
+            first = std::min(first, y);
+            last = std::max(last, y);
+        }
+    }
+    world.first_changed[b ^ 1] = first;
+    world.last_changed[b ^ 1] = last;
+    world.hashes[b ^ 1] = hash;
+    world.near_edge = near_edge;
+    world.gen++;
+}
+
+static inline int soup_population(const soup_board& board)
+{
+    int population = 0;
+    for (int y = 0; y < soup_board_size; y++) {
+        population += soup_popcount(board.rows[y]);
+    }
+    return population;
+}
+
+/* Gets the bounding box of the alive cells, returns false if there are none. */
+static bool soup_bounds(const soup_board& board, int& x0, int& y0, int& x1, int& y1)
+{
+    soup_row any = {};
+    y0 = soup_board_size;
+    y1 = -1;
+    for (int y = 0; y < soup_board_size; y++) {
+        if (board.rows[y]) {
+            any |= board.rows[y];
+            y0 = std::min(y0, y);
+            y1 = y;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+    x0 = soup_first(any);
+    x1 = soup_last(any);
+    return true;
+}
+
+/* Moves the cells of a board dx columns right and dy rows down, cells moved
+past the edges are lost. */
+static soup_board soup_translate(const soup_board& board, int dx, int dy)
+{
+    soup_board moved = {};
+    for (int y = 0; y < soup_board_size; y++) {
+        int to = y + dy;
+        if (to < 0 || to >= soup_board_size || !board.rows[y] || std::abs(dx) >= soup_board_size) {
+            continue;
+        }
+        moved.rows[to] = dx >= 0 ? board.rows[y] << dx : board.rows[y] >> -dx;
+    }
+    return moved;
+}
+
+/* Gets the 8-connected cells of the mask that include the cell at x, y. */
+static soup_board soup_component(const soup_board& mask, int x, int y)
+{
+    soup_board component = {};
+    component.rows[y] = soup_cell(x);
+
+    // Only the rows of the component and the rows next to them can grow.
+    int y0 = y, y1 = y;
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        int from = std::max(y0 - 1, 0), to = std::min(y1 + 1, soup_board_size - 1);
+        soup_row north = {};
+        if (from > 0) {
+            north = component.rows[from - 1] | component.rows[from - 1] << 1 | component.rows[from - 1] >> 1;
+        }
+        soup_row center = component.rows[from] | component.rows[from] << 1 | component.rows[from] >> 1;
+        for (int y = from; y <= to; y++) {
+            soup_row south = {};
+            if (y < soup_board_size - 1) {
+                soup_row row = component.rows[y + 1];
+                south = row | row << 1 | row >> 1;
+            }
+            soup_row row = (north | center | south) & mask.rows[y];
+            if (row != component.rows[y]) {
+                grown = true;
+                y0 = std::min(y0, y);
+                y1 = std::max(y1, y);
+            }
+            north = center;
+            center = south;
+            component.rows[y] = row;
+        }
+    }
+    return component;
+}
+
+/* Encodes cells of a bounding box of width x height in one of its 8 rotations
+and reflections, the size first and then one bit per cell row by row. */
+static std::string soup_encode(const std::vector<std::pair<int, int>>& cells, int width, int height,
+    int transform)
+{
+    bool swap = transform & 4;
+    int out_width = swap ? height : width;
+    int out_height = swap ? width : height;
+    std::vector<uint64_t> rows(out_height);
+    for (const std::pair<int, int>& cell : cells) {
+        int x = transform & 1 ? width - 1 - cell.first : cell.first;
+        int y = transform & 2 ? height - 1 - cell.second : cell.second;
+        if (swap) {
+            std::swap(x, y);
+        }
+        rows[y] |= 1ULL << x;
+    }
+    std::string code(1, (char)out_width);
+    code += (char)out_height;
+    for (uint64_t row : rows) {
+        code.append((const char*)&row, (out_width + 7) / 8);
+    }
+    return code;
+}
+
+/* Returns the smallest encoding of the cells of a board over its 8 rotations
+and reflections. */
+static std::string soup_canonical(const soup_board& board)
+{
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    soup_bounds(board, x0, y0, x1, y1);
+    std::vector<std::pair<int, int>> cells;
+    for (int y = y0; y <= y1; y++) {
+        for (soup_row row = board.rows[y] >> x0; row; row ^= soup_cell(soup_first(row))) {
+            cells.push_back(std::make_pair(soup_first(row), y - y0));
+        }
+    }
+    std::string best;
+    for (int transform = 0; transform < 8; transform++) {
+        std::string code = soup_encode(cells, x1 - x0 + 1, y1 - y0 + 1, transform);
+        if (!transform || code < best) {
+            best = code;
+        }
+    }
+    return best;
+}
+
+/* Returns the rows of the cells moved to the top left corner, as the key of the
+phase they are in. */
+static std::string soup_phase_key(const soup_board& board)
+{
+    int x0, y0, x1, y1;
+    if (!soup_bounds(board, x0, y0, x1, y1)) {
+        return std::string();
+    }
+    std::string key;
+    for (int y = y0; y <= y1; y++) {
+        soup_row row = board.rows[y] >> x0;
+        key.append((const char*)&row, sizeof(row));
+    }
+    return key;
+}
+
+/* Simulates an object on a board of its own until it returns to its shape in
+at most max_period generations. Gets its period, how far it moved and its
+canonical form, the smallest over its phases, returns false if it does not
+return to its shape or grows too large. */
+static bool soup_identify(const soup_board& object, int max_period, int& period, int& population,
+    bool& moves, std::string& canonical)
+{
+    int x0, y0, x1, y1;
+    if (!soup_bounds(object, x0, y0, x1, y1) || x1 - x0 >= soup_max_object_size ||
+        y1 - y0 >= soup_max_object_size) {
+        return false;
+    }
+    soup_board board = soup_translate(object, (soup_board_size - (x1 - x0 + 1)) / 2 - x0,
+        (soup_board_size - (y1 - y0 + 1)) / 2 - y0);
+    soup_bounds(board, x0, y0, x1, y1);
+    std::string key = soup_phase_key(board);
+    population = soup_population(board);
+    canonical = soup_canonical(board);
+
+    soup_state state = soup_scan(board);
+    for (period = 1; period <= max_period; period++) {
+        state = soup_step(board, state);
+        if (state.last < 0 || soup_near_edge(state)) {
+            return false;
+        }
+        int bx0, by0, bx1, by1;
+        soup_bounds(board, bx0, by0, bx1, by1);
+        if (soup_phase_key(board) == key) {
+            moves = bx0 != x0 || by0 != y0;
+            return true;
+        }
+        canonical = std::min(canonical, soup_canonical(board));
+    }
+    return false;
+}
+
+/* Returns the name of the canonical form of a common object, empty if it is not
+one. */
+static std::string soup_common_name(const std::string& canonical)
+{
+    static const struct
+    {
+        const char* name;
+        const char* rows[4];
+    } common[] = {
+        {"block", {"oo", "oo"}},
+        {"beehive", {".oo.", "o..o", ".oo."}},
+        {"loaf", {".oo.", "o..o", ".o.o", "..o."}},
+        {"boat", {"oo.", "o.o", ".o."}},
+        {"ship", {"oo.", "o.o", ".oo"}},
+        {"tub", {".o.", "o.o", ".o."}},
+        {"pond", {".oo.", "o..o", "o..o", ".oo."}},
+        {"blinker", {"ooo"}},
+        {"toad", {".ooo", "ooo."}},
+        {"beacon", {"oo..", "oo..", "..oo", "..oo"}},
+        {"glider", {".o.", "..o", "ooo"}},
+        {"lwss", {".o..o", "o....", "o...o", "oooo."}},
+    };
+
+    // Built once, by the first thread to get here.
+    static const std::unordered_map<std::string, std::string> names = [] {
+        std::unordered_map<std::string, std::string> names;
+        for (const auto& object : common) {
+            soup_board board = {};
+            for (int y = 0; y < 4 && object.rows[y]; y++) {
+                for (int x = 0; object.rows[y][x]; x++) {
+                    if (object.rows[y][x] == 'o') {
+                        board.rows[y] |= soup_cell(x);
+                    }
+                }
+            }
+            int period, population;
+            bool moves;
+            std::string canonical;
+            if (soup_identify(board, soup_max_period, period, population, moves, canonical)) {
+                names[canonical] = object.name;
+            }
+        }
+        return names;
+    }();
+
+    auto it = names.find(canonical);
+    return it == names.end() ? std::string() : it->second;
+}
+
+/* Returns the apgcode-like name of an object, empty if it cannot be identified
+in max_period generations. Names are cached by the phase the object is in. */
+static std::string soup_name(const soup_board& object, int max_period, soup_names& cache)
+{
+    std::string key = soup_phase_key(object);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    int period, population;
+    bool moves;
+    std::string canonical;
+    if (!soup_identify(object, max_period, period, population, moves, canonical)) {
+        return std::string();
+    }
+
+    char prefix[32];
+    if (moves) {
+        sprintf(prefix, "xq%d_", period);
+    }
+    else if (period == 1) {
+        sprintf(prefix, "xs%d_", population);
+    }
+    else {
+        sprintf(prefix, "xp%d_", period);
+    }
+    std::string name = soup_common_name(canonical);
+    if (name.empty()) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : canonical) {
+            hash = (hash ^ (uint8_t)c) * 0x100000001b3ULL;
+        }
+        char hex[17];
+        sprintf(hex, "%016llx", (unsigned long long)hash);
+        name = hex;
+    }
+    name = prefix + name;
+    cache[key] = name;
+    return name;
+}
+
+/* Removes the spaceships among the objects near the edges and adds their names,
+returns false if any of the objects is not a spaceship. */
+static bool soup_remove_spaceships(soup_board& board, std::vector<std::string>& found, soup_names& cache)
+{
+    soup_board edge = {};
+    for (int y = 0; y < soup_board_size; y++) {
+        bool edge_row = y < soup_edge_rows || y >= soup_board_size - soup_edge_rows;
+        edge.rows[y] = edge_row ? board.rows[y] : board.rows[y] & soup_edge_columns;
+    }
+    for (int y = 0; y < soup_board_size; y++) {
+        while (edge.rows[y]) {
+            soup_board object = soup_component(board, soup_first(edge.rows[y]), y);
+            std::string name = soup_name(object, soup_max_spaceship_period, cache);
+            if (name.compare(0, 2, "xq")) {
+                return false;
+            }
+            found.push_back(name);
+            for (int i = 0; i < soup_board_size; i++) {
+                board.rows[i] &= ~object.rows[i];
+                edge.rows[i] &= ~object.rows[i];
+            }
+        }
+    }
+    return true;
+}
+
+/* Adds the names of the objects of a board that repeats every period
+generations. Objects are the connected cells of every phase together, so that
+the parts of an oscillator that touch in some phases are one object. */
+static void soup_add_objects(const soup_board& board, int period, std::vector<std::string>& found,
+    soup_names& cache)
+{
+    soup_board phases = board;
+    soup_board phase = board;
+    soup_state state = soup_scan(phase);
+    for (int i = 1; i < period; i++) {
+        state = soup_step(phase, state);
+        for (int y = 0; y < soup_board_size; y++) {
+            phases.rows[y] |= phase.rows[y];
+        }
+    }
+    for (int y = 0; y < soup_board_size; y++) {
+        while (phases.rows[y]) {
+            soup_board mask = soup_component(phases, soup_first(phases.rows[y]), y);
+            soup_board object;
+            for (int i = 0; i < soup_board_size; i++) {
+                object.rows[i] = board.rows[i] & mask.rows[i];
+                phases.rows[i] &= ~mask.rows[i];
+            }
+            std::string name = soup_name(object, period, cache);
+            found.push_back(name.empty() ? "unknown" : name);
+        }
+    }
+}
+
+static inline uint64_t splitmix64(uint64_t& state)
+{
+    return soup_mix(state += 0x9e3779b97f4a7c15ULL);
+}
+
+/* Puts soup index of a seed in the middle of an empty board. Every soup takes
+its cells from a stream of its own, so soups do not depend on the order they
+are generated in. */
+static void soup_generate(uint64_t seed, uint64_t index, soup_board& board)
+{
+    uint64_t state = seed;
+    state = splitmix64(state) + index * (soup_size * soup_size / 64) * 0x9e3779b97f4a7c15ULL;
+    memset(&board, 0, sizeof(board));
+    int offset = (soup_board_size - soup_size) / 2;
+    for (int i = 0; i < soup_size * soup_size / 64; i++) {
+        uint64_t bits = splitmix64(state);
+        for (int j = 0; j < 64 / soup_size; j++) {
+            soup_row row = {};
+            row.words[0] = (bits >> (j * soup_size)) & ((1ULL << soup_size) - 1);
+            board.rows[offset + i * (64 / soup_size) + j] = row << offset;
+        }
+    }
+}
+
+/* Simulates a soup until the board repeats and adds the names of its objects,
+returns false if it does not settle. */
+static bool soup_run(soup_world& world, std::vector<std::string>& found, soup_names& cache)
+{
+    // Hashes of the last soup_max_period boards, by generation.
+    uint64_t history[soup_max_period + 1];
+    for (int gen = 0; gen < soup_max_gens; gen++) {
+        if (world.near_edge) {
+            // The world starts again from the board without the spaceships,
+            // so the generation count goes on here.
+            soup_board board = soup_world_board(world);
+            if (!soup_remove_spaceships(board, found, cache)) {
+                return false;
+            }
+            soup_world_start(world, board);
+        }
+        uint64_t hash = soup_world_hash(world);
+        for (int period = 1; period <= std::min(gen, soup_max_period); period++) {
+            if (history[(gen - period) % (soup_max_period + 1)] == hash) {
+                soup_add_objects(soup_world_board(world), period, found, cache);
+                return true;
+            }
+        }
+        history[gen % (soup_max_period + 1)] = hash;
+        soup_world_step(world);
+    }
+    return false;
+}
+
+soup_census soup_search(uint64_t seed, uint64_t start, uint64_t soups, int threads)
+{
+    if (threads <= 0) {
+        threads = omp_get_num_procs();
+    }
+    std::vector<std::map<std::string, uint64_t>> objects(threads);
+    std::vector<uint64_t> unsettled(threads);
+
+    my_timer timer;
+    timer.start();
+    #pragma omp parallel num_threads(threads) default(none) shared(seed, start, soups, objects, unsettled)
+    {
+        int tid = omp_get_thread_num();
+        std::map<std::string, uint64_t>& census = objects[tid];
+        soup_names cache;
+        std::vector<std::string> found;
+        soup_board board;
+        std::unique_ptr<soup_world> world(new soup_world);
+
+        #pragma omp for schedule(dynamic, soup_chunk)
+        for (int64_t i = 0; i < (int64_t)soups; i++) {
+            soup_generate(seed, start + i, board);
+            soup_world_start(*world, board);
+            found.clear();
+            if (!soup_run(*world, found, cache)) {
+                unsettled[tid]++;
+                continue;
+            }
+            for (const std::string& name : found) {
+                census[name]++;
+            }
+        }
+    }
+
+    // Every thread counted its own soups, merged in the same order every time.
+    soup_census result;
+    result.soups = soups;
+    result.unsettled = 0;
+    for (int i = 0; i < threads; i++) {
+        result.unsettled += unsettled[i];
+        for (const auto& object : objects[i]) {
+            result.objects[object.first] += object.second;
+        }
+    }
+    result.seconds = timer.stop() / 1000;
+    return result;
+}
@@ -0,0 +1,208 @@
+/**
+ * trace.cpp
+ *
+ * Per-thread event buffers and Chrome trace JSON export. Empty unless
+ * GOL_TRACE is defined.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#ifdef GOL_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <trace.hpp>
+
+// Events per thread, 40 bytes each.
+const size_t trace_capacity = 1 << 18;
+
+// Depth of nested events per thread.
+const int trace_max_depth = 16;
+
+struct trace_event
+{
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+    int track;
+    int gen;
+};
+
+/* Events of one thread. Only the thread writes to it, the count is published
+with release so that trace_write() can read the events before it. */
+struct trace_buffer
+{
+    int track;
+    std::atomic<size_t> count;
+    std::atomic<size_t> dropped;
+    trace_event events[trace_capacity];
+
+    // Events started and not yet ended.
+    int depth;
+    const char* open_names[trace_max_depth];
+    int open_gens[trace_max_depth];
+    uint64_t open_begins[trace_max_depth];
+};
+
+// Buffers and track names of every thread that has recorded. Buffers are
+// never freed, since a trace may be written after their threads exit.
+static std::mutex trace_mutex;
+static std::vector<trace_buffer*> trace_buffers;
+static std::vector<std::string> trace_tracks;
+
+uint64_t trace_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int trace_track(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    std::vector<std::string>::iterator it = std::find(trace_tracks.begin(), trace_tracks.end(), name);
+    if (it != trace_tracks.end()) {
+        return it - trace_tracks.begin();
+    }
+    trace_tracks.push_back(name);
+    return trace_tracks.size() - 1;
+}
+
+/* Returns the buffer of the calling thread, created on first use. */
+static trace_buffer& thread_buffer()
+{
+    static thread_local trace_buffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = new trace_buffer;
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->depth = 0;
+
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        buffer->track = trace_tracks.size();
+        trace_tracks.push_back("Thread " + std::to_string(trace_buffers.size()));
+        trace_buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void trace_record(int track, const char* name, int gen, uint64_t begin, uint64_t end)
+{
+    trace_buffer& buffer = thread_buffer();
+    size_t count = buffer.count.load(std::memory_order_relaxed);
+    if (count == trace_capacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[count] = trace_event{name, begin, end, track, gen};
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void trace_begin(const char* name, int gen)
+{
+    trace_buffer& buffer = thread_buffer();
+    if (buffer.depth < trace_max_depth) {
+        buffer.open_names[buffer.depth] = name;
+        buffer.open_gens[buffer.depth] = gen;
+        buffer.open_begins[buffer.depth] = trace_now();
+    }
+    buffer.depth++;
+}
+
+void trace_end()
+{
+    uint64_t end = trace_now();
+    trace_buffer& buffer = thread_buffer();
+    if (!buffer.depth) {
+        return;
+    }
+    buffer.depth--;
+    if (buffer.depth < trace_max_depth) {
+        trace_record(buffer.track, buffer.open_names[buffer.depth], buffer.open_gens[buffer.depth],
+            buffer.open_begins[buffer.depth], end);
+    }
+}
+
+/* Writes s as a JSON string. */
+static void write_json_string(FILE* file, const char* s)
+{
+    fputc('"', file);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', file);
+        }
+        if ((unsigned char)*s >= 0x20) {
+            fputc(*s, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void trace_write(const char* path)
+{
+    if (!path) {
+        path = getenv("GOL_TRACE_FILE");
+    }
+    if (!path || !*path) {
+        path = "game_of_life_trace.json";
+    }
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        throw std::runtime_error("cannot open " + std::string(path) + ": " + std::string(strerror(errno)));
+    }
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+
+    // Timestamps are in us from the first event.
+    uint64_t origin = UINT64_MAX;
+    for (trace_buffer* buffer : trace_buffers) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            origin = std::min(origin, buffer->events[i].begin);
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (size_t track = 0; track < trace_tracks.size(); track++) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":",
+            first ? "" : ",\n", track);
+        write_json_string(file, trace_tracks[track].c_str());
+        fprintf(file, "}}");
+        first = false;
+    }
+    size_t dropped = 0;
+    for (trace_buffer* buffer : trace_buffers) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const trace_event& event = buffer->events[i];
+            fprintf(file, ",\n{\"name\":");
+            write_json_string(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", event.track,
+                (event.begin - origin) / 1000.0, (event.end - event.begin) / 1000.0);
+            if (event.gen >= 0) {
+                fprintf(file, ",\"args\":{\"gen\":%d}", event.gen);
+            }
+            fprintf(file, "}");
+        }
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    if (dropped) {
+        std::cerr << "Trace buffers full, " << dropped << " events dropped" << std::endl;
+    }
+}
+
+#endif
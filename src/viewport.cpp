@@ -0,0 +1,292 @@
+/**
+ * viewport.cpp
+ *
+ * Viewport pixels and the shared memory ring of frames, see viewport.hpp.
+ *
+ * Author: Carl Marquez
+ * Created on: October 18, 2026
+ */
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include <viewport.hpp>
+
+// Marks shared memory as a ring of this layout.
+const uint32_t viewport_magic = 0x474f4c31;
+
+// Times a reader tries to get the latest frame while the writer replaces it.
+const int viewport_read_tries = 1000;
+
+// Header and slots start at multiples of a cache line, so that a slot being
+// written does not share a line with the slot before it.
+const size_t viewport_align = 64;
+
+struct viewport_ring::header
+{
+    uint32_t magic;
+    int32_t frame_width;
+    int32_t frame_height;
+    int32_t slots;
+    uint64_t slot_size;
+
+    // Frames published so far, the latest is in slot (published - 1) % slots.
+    std::atomic<uint64_t> published;
+};
+
+struct viewport_ring::slot_header
+{
+    // Odd while the writer draws into the slot.
+    std::atomic<uint64_t> seq;
+    int64_t gen;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && ATOMIC_LLONG_LOCK_FREE == 2,
+    "the ring needs atomics that work between processes");
+
+void viewport_check(const viewport& view, int world_width, int world_height)
+{
+    if (view.scale < 1) {
+        throw std::invalid_argument("viewport scale must be at least 1");
+    }
+    if (view.width < view.scale || view.height < view.scale || view.width % view.scale ||
+        view.height % view.scale) {
+        throw std::invalid_argument("viewport width and height must be positive multiples of its scale");
+    }
+    if (view.x < 0 || view.y < 0 || view.x > world_width - view.width || view.y > world_height - view.height) {
+        throw std::invalid_argument("viewport must be inside the world");
+    }
+    if (view.mode != viewport_density && view.mode != viewport_max) {
+        throw std::invalid_argument("viewport mode must be a viewport_mode");
+    }
+}
+
+void viewport_add_row(const viewport& view, const char* row, uint32_t* counts)
+{
+    const char* p = row + view.x;
+    int frame_width = view.frame_width();
+    int scale = view.scale;
+
+    // Blocks of whole vectors are summed 16 cells at a time.
+    if (!(scale % 16)) {
+        for (int px = 0; px < frame_width; px++, p += scale) {
+            __m128i sum = _mm_setzero_si128();
+            for (int x = 0; x < scale; x += 16) {
+                sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_loadu_si128((__m128i*)(p + x)), _mm_setzero_si128()));
+            }
+            counts[px] += _mm_cvtsi128_si64(_mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum)));
+        }
+        return;
+    }
+    for (int px = 0; px < frame_width; px++, p += scale) {
+        uint32_t count = 0;
+        for (int x = 0; x < scale; x++) {
+            count += p[x];
+        }
+        counts[px] += count;
+    }
+}
+
+void viewport_draw(const viewport& view, const uint32_t* counts, uint8_t* pixels)
+{
+    size_t pixel_count = (size_t)view.frame_width() * view.frame_height();
+    if (view.mode == viewport_max) {
+        for (size_t i = 0; i < pixel_count; i++) {
+            pixels[i] = counts[i] ? 255 : 0;
+        }
+        return;
+    }
+    uint64_t block_cells = (uint64_t)view.scale * view.scale;
+    for (size_t i = 0; i < pixel_count; i++) {
+        pixels[i] = counts[i] * (uint64_t)255 / block_cells;
+    }
+}
+
+/* Returns the shared memory name of a ring, which must start with a slash. */
+static std::string shm_name(const std::string& name)
+{
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+viewport_ring::viewport_ring(const std::string& name, int frame_width, int frame_height, int slots) :
+    _name(shm_name(name)), _owner(true)
+{
+    if (frame_width < 1 || frame_height < 1) {
+        throw std::invalid_argument("frame width and height must be at least 1");
+    }
+    if (slots < 2) {
+        throw std::invalid_argument("ring must have at least 2 slots");
+    }
+    size_t pixels = (size_t)frame_width * frame_height;
+    size_t slot_size = (viewport_align + pixels + viewport_align - 1) / viewport_align * viewport_align;
+    _size = viewport_align + slot_size * slots;
+
+    int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("cannot create " + _name + ": " + std::string(strerror(errno)));
+    }
+    if (ftruncate(fd, _size)) {
+        int err = errno;
+        close(fd);
+        shm_unlink(_name.c_str());
+        throw std::runtime_error("cannot size " + _name + ": " + std::string(strerror(err)));
+    }
+    _memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_memory == MAP_FAILED) {
+        int err = errno;
+        shm_unlink(_name.c_str());
+        throw std::runtime_error("cannot map " + _name + ": " + std::string(strerror(err)));
+    }
+
+    // Shared memory starts zeroed, so every sequence number and the count of
+    // published frames start at 0. The magic goes last, readers that see it
+    // see the rest of the header.
+    _header = (header*)_memory;
+    _header->frame_width = frame_width;
+    _header->frame_height = frame_height;
+    _header->slots = slots;
+    _header->slot_size = slot_size;
+    std::atomic_thread_fence(std::memory_order_release);
+    _header->magic = viewport_magic;
+}
+
+viewport_ring::viewport_ring(const std::string& name) : _name(shm_name(name)), _owner(false)
+{
+    int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + _name + ": " + std::string(strerror(errno)));
+    }
+    struct stat st;
+    if (fstat(fd, &st)) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("cannot stat " + _name + ": " + std::string(strerror(err)));
+    }
+    _size = st.st_size;
+    if (_size < viewport_align) {
+        close(fd);
+        throw std::runtime_error(_name + " is not a viewport ring");
+    }
+    _memory = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_memory == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + _name + ": " + std::string(strerror(errno)));
+    }
+    _header = (header*)_memory;
+    if (_header->magic != viewport_magic || viewport_align + _header->slot_size * _header->slots > _size) {
+        munmap(_memory, _size);
+        throw std::runtime_error(_name + " is not a viewport ring");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+viewport_ring::~viewport_ring()
+{
+    munmap(_memory, _size);
+    if (_owner) {
+        shm_unlink(_name.c_str());
+    }
+}
+
+viewport_ring::slot_header* viewport_ring::slot(int i) const
+{
+    return (slot_header*)((char*)_memory + viewport_align + _header->slot_size * i);
+}
+
+int viewport_ring::frame_width() const
+{
+    return _header->frame_width;
+}
+
+int viewport_ring::frame_height() const
+{
+    return _header->frame_height;
+}
+
+uint8_t* viewport_ring::begin_frame()
+{
+    if (!_owner) {
+        throw std::logic_error("only the process that created a ring writes to it");
+    }
+    uint64_t published = _header->published.load(std::memory_order_relaxed);
+    slot_header* s = slot(published % _header->slots);
+    s->seq.store(s->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return (uint8_t*)s + viewport_align;
+}
+
+void viewport_ring::publish(int64_t gen)
+{
+    uint64_t published = _header->published.load(std::memory_order_relaxed);
+    slot_header* s = slot(published % _header->slots);
+    s->gen = gen;
+    s->seq.store(s->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    _header->published.store(published + 1, std::memory_order_release);
+}
+
+bool viewport_ring::latest(viewport_frame& frame) const
+{
+    // The latest slot is only written again after slots more frames, so the
+    // first try nearly always succeeds. A writer that died while drawing a
+    // frame leaves its slot odd, so the tries are bounded.
+    for (int tries = 0; tries < viewport_read_tries; tries++) {
+        uint64_t published = _header->published.load(std::memory_order_acquire);
+        if (!published) {
+            return false;
+        }
+        int i = (published - 1) % _header->slots;
+        slot_header* s = slot(i);
+        uint64_t seq = s->seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        frame.pixels = (const uint8_t*)s + viewport_align;
+        frame.width = _header->frame_width;
+        frame.height = _header->frame_height;
+        frame.gen = s->gen;
+        frame.seq = seq;
+        frame.slot = i;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->seq.load(std::memory_order_relaxed) == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool viewport_ring::frame(uint64_t n, viewport_frame& frame) const
+{
+    uint64_t published = _header->published.load(std::memory_order_acquire);
+    if (n >= published || published - n > (uint64_t)_header->slots) {
+        return false;
+    }
+
+    // Every frame drawn into a slot adds 2 to its sequence number, so frame n
+    // is in its slot as long as the slot has seen n / slots + 1 frames.
+    int i = n % _header->slots;
+    slot_header* s = slot(i);
+    uint64_t seq = s->seq.load(std::memory_order_acquire);
+    if (seq != 2 * (n / _header->slots + 1)) {
+        return false;
+    }
+    frame.pixels = (const uint8_t*)s + viewport_align;
+    frame.width = _header->frame_width;
+    frame.height = _header->frame_height;
+    frame.gen = s->gen;
+    frame.seq = seq;
+    frame.slot = i;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s->seq.load(std::memory_order_relaxed) == seq;
+}
+
+bool viewport_ring::valid(const viewport_frame& frame) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(frame.slot)->seq.load(std::memory_order_relaxed) == frame.seq;
+}